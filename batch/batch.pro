@@ -0,0 +1,11 @@
+QT -= gui
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = lorentz-batch
+
+include(../src/core/core.pri)
+
+SOURCES += ../src/batch.cpp
@@ -5,17 +5,23 @@ CONFIG -= console
 
 TARGET = lorentz
 
-HEADERS = src/model.h \
+include(src/core/core.pri)
+
+HEADERS += src/renderer.h \
+          src/simulation.h \
           src/widget.h \
           src/window.h \
           src/qcustomplot.h \
+          src/qcustomplotdata.h \
     src/aboutdialog.h
 
-SOURCES = src/model.cpp \
+SOURCES += src/renderer.cpp \
+          src/simulation.cpp \
           src/main.cpp \
           src/widget.cpp \
           src/window.cpp \
           src/qcustomplot.cpp \
+          src/qcustomplotdata.cpp \
     src/aboutdialog.cpp
 
 FORMS = src/window.ui \
@@ -24,9 +30,3 @@ FORMS = src/window.ui \
 TRANSLATIONS = translations/lorentz_ru.ts
 
 RESOURCES += resources.qrc
-
-
-
-
-
-
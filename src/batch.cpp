@@ -0,0 +1,445 @@
+/*
+ * lorentz-batch: runs the model without a GUI as fast as the CPU allows
+ * and writes the measured series to disk.
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFile>
+#include <QTextStream>
+#include <QRegExp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "model.h"
+#include "parameters.h"
+#include "ensemble.h"
+#include "sweep.h"
+#include "streamwriter.h"
+
+struct Options {
+	Parameters params;
+	int duration, step;
+	int replicas;
+	QString output;
+	QString stream;		// format of the streamed measurements, empty for none
+
+	// grids of a parameter sweep
+	QVector<int> sides;
+	QVector<qreal> atomRs;
+	QVector<qreal> electronRs;
+	QVector<qreal> speeds;
+};
+
+static void usage()
+{
+	fprintf(stderr,
+		"Usage: lorentz-batch [options]\n"
+		"  --side N,...      lattice side (25)\n"
+		"  --lattice L       square, triangular or disordered (square)\n"
+		"  --atoms FILE      disordered atoms, x y per line (random, as dense\n"
+		"                    as the square lattice or as many as fit; the\n"
+		"                    count placed goes to PREFIX_atoms.csv, or the\n"
+		"                    atoms column of PREFIX_sweep.csv)\n"
+		"  --boundary B      reflecting or periodic; a single periodic run also\n"
+		"                    writes the unwrapped displacements to\n"
+		"                    PREFIX_displacement.csv (reflecting)\n"
+		"  --atomR R,...     atom radius (5)\n"
+		"  --electronR R,... electron radius (2)\n"
+		"  --speed V,...     electron speed (100)\n"
+		"  --num N           number of electrons (100)\n"
+		"  --nbins N         number of bins (3)\n"
+		"  --bin N           bin to estimate the probability, from 1 (1)\n"
+		"  --duration MS     simulated time in milliseconds (60000)\n"
+		"  --step MS         time step in milliseconds (50)\n"
+		"  --width W         field width (400)\n"
+		"  --height H        field height (400)\n"
+		"  --threads N       worker threads, 0 for all cores (0)\n"
+		"  --seed N          random seed (1)\n"
+		"  --engine E        timestep or event (timestep)\n"
+		"  --replicas N      independent runs seeded seed, seed+1, ... (1); the\n"
+		"                    density is then written at every measurement\n"
+		"  --history H       ring or downsample, how long series are kept (downsample)\n"
+		"  --history-size N  points kept in the series (100000)\n"
+		"  --stream F        csv or binary, streams every measurement of a single\n"
+		"                    run to PREFIX_stream.csv or PREFIX_stream.bin\n"
+		"  --output PREFIX   output files prefix (lorentz)\n"
+		"Several comma separated values of side, atomR, electronR or speed\n"
+		"run a sweep over their grid and write PREFIX_sweep.csv.\n");
+}
+
+static bool parseList(const QString& value, QVector<int>& list)
+{
+	list.clear();
+	QStringList items = value.split(",");
+	for (int i = 0; i < items.size(); i++) {
+		bool ok;
+		list.append(items[i].toInt(&ok));
+		if (!ok)
+			return false;
+	}
+	return true;
+}
+
+static bool parseList(const QString& value, QVector<qreal>& list)
+{
+	list.clear();
+	QStringList items = value.split(",");
+	for (int i = 0; i < items.size(); i++) {
+		bool ok;
+		list.append(items[i].toDouble(&ok));
+		if (!ok)
+			return false;
+	}
+	return true;
+}
+
+static bool readAtoms(const QString& filename, QVector<QPointF>& atoms)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+	QTextStream in(&file);
+
+	atoms.clear();
+	while (!in.atEnd()) {
+		QStringList items = in.readLine().split(QRegExp("[\\s,]+"), QString::SkipEmptyParts);
+		if (items.isEmpty())
+			continue;
+		if (items.size() < 2)
+			return false;
+		bool okX, okY;
+		qreal x = items[0].toDouble(&okX);
+		qreal y = items[1].toDouble(&okY);
+		if (!okX || !okY)
+			return false;
+		atoms.append(QPointF(x, y));
+	}
+	return true;
+}
+
+static bool parse(const QStringList& args, Options& opt)
+{
+	Parameters& p = opt.params;
+	opt.duration = 60000;
+	opt.step = 50;
+	opt.replicas = 1;
+	opt.output = "lorentz";
+	opt.sides = QVector<int>(1, p.side);
+	opt.atomRs = QVector<qreal>(1, p.atomR);
+	opt.electronRs = QVector<qreal>(1, p.electronR);
+	opt.speeds = QVector<qreal>(1, p.speed);
+
+	for (int i = 1; i < args.size(); i += 2) {
+		if (i + 1 >= args.size())
+			return false;
+		QString name = args[i];
+		QString value = args[i+1];
+		bool ok = true;
+		if (name == "--side")
+			ok = parseList(value, opt.sides);
+		else if (name == "--atomR")
+			ok = parseList(value, opt.atomRs);
+		else if (name == "--electronR")
+			ok = parseList(value, opt.electronRs);
+		else if (name == "--speed")
+			ok = parseList(value, opt.speeds);
+		else if (name == "--lattice") {
+			ok = value == "square" || value == "triangular" || value == "disordered";
+			if (value == "triangular")
+				p.geometry = Model::TriangularGeometry;
+			else if (value == "disordered")
+				p.geometry = Model::DisorderedGeometry;
+			else
+				p.geometry = Model::SquareGeometry;
+		}
+		else if (name == "--boundary") {
+			ok = value == "reflecting" || value == "periodic";
+			p.boundary = value == "periodic" ? Model::PeriodicBoundary : Model::ReflectingBoundary;
+		}
+		else if (name == "--atoms")
+			ok = readAtoms(value, p.scatterers);
+		else if (name == "--num")
+			p.num = value.toInt(&ok);
+		else if (name == "--nbins")
+			p.nbins = value.toInt(&ok);
+		else if (name == "--bin")
+			p.bin = value.toInt(&ok);
+		else if (name == "--duration")
+			opt.duration = value.toInt(&ok);
+		else if (name == "--step")
+			opt.step = value.toInt(&ok);
+		else if (name == "--width")
+			p.width = value.toInt(&ok);
+		else if (name == "--height")
+			p.height = value.toInt(&ok);
+		else if (name == "--threads")
+			p.threads = value.toInt(&ok);
+		else if (name == "--seed")
+			p.seed = value.toInt(&ok);
+		else if (name == "--engine") {
+			ok = value == "timestep" || value == "event";
+			p.engine = value == "event" ? Model::EventDrivenEngine : Model::TimeStepEngine;
+		}
+		else if (name == "--history") {
+			ok = value == "ring" || value == "downsample";
+			p.history = value == "ring" ? Model::RingHistory : Model::DownsampledHistory;
+		}
+		else if (name == "--history-size")
+			p.historySize = value.toInt(&ok);
+		else if (name == "--replicas")
+			opt.replicas = value.toInt(&ok);
+		else if (name == "--stream") {
+			ok = value == "csv" || value == "binary";
+			opt.stream = value;
+		}
+		else if (name == "--output")
+			opt.output = value;
+		else
+			ok = false;
+		if (!ok) {
+			fprintf(stderr, "Bad option: %s %s\n", qPrintable(name), qPrintable(value));
+			return false;
+		}
+	}
+
+	p.side = opt.sides[0];
+	p.atomR = opt.atomRs[0];
+	p.electronR = opt.electronRs[0];
+	p.speed = opt.speeds[0];
+
+	bool valid = p.nbins > 0 && p.bin >= 1 && p.bin <= p.nbins &&
+		opt.step > 0 && p.width > 0 && p.height > 0 && p.num >= 0 &&
+		opt.replicas >= 1 && p.historySize > 0;
+	for (int i = 0; i < opt.sides.size(); i++)
+		valid = valid && opt.sides[i] > 0;
+	if (!opt.stream.isEmpty())
+		valid = valid && opt.replicas == 1 && opt.sides.size() == 1 && opt.atomRs.size() == 1 &&
+			opt.electronRs.size() == 1 && opt.speeds.size() == 1;
+	if (!valid) {
+		fprintf(stderr, "Parameters out of range\n");
+		return false;
+	}
+	return true;
+}
+
+static bool writeSweep(const Sweep& sweep, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<Sweep::Result> results = sweep.getResults();
+	bool disordered = !results.isEmpty() && results[0].params.geometry == Model::DisorderedGeometry;
+	out << "side,atomR,electronR,speed,prob,pressure";
+	if (disordered)
+		out << ",atoms";
+	if (!results.isEmpty()) {
+		for (int b = 0; b < results[0].density.size(); b++)
+			out << ",density_" << b+1;
+	}
+	out << "\n";
+	for (int i = 0; i < results.size(); i++) {
+		const Sweep::Result& r = results[i];
+		out << r.params.side << "," << r.params.atomR << "," << r.params.electronR << ","
+			<< r.params.speed << "," << r.prob << "," << r.pressure;
+		if (disordered)
+			out << "," << r.atoms;
+		for (int b = 0; b < r.density.size(); b++)
+			out << "," << r.density[b];
+		out << "\n";
+	}
+	return out.status() == QTextStream::Ok;
+}
+
+static bool writeSeries(const Ensemble& ensemble, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<qreal> time = ensemble.getTime();
+	Ensemble::Series prob = ensemble.getProb();
+	Ensemble::Series pressure = ensemble.getPressure();
+	out << "time,prob_mean,prob_var,pressure_mean,pressure_var\n";
+	for (int i = 0; i < time.size(); i++)
+		out << time[i] << "," << prob.mean[i] << "," << prob.variance[i] << ","
+			<< pressure.mean[i] << "," << pressure.variance[i] << "\n";
+	return out.status() == QTextStream::Ok;
+}
+
+static bool writeDensity(const Ensemble& ensemble, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<qreal> time = ensemble.getTime();
+	QVector<Ensemble::Series> density = ensemble.getDensity();
+	out << "time,bin,density_mean,density_var\n";
+	for (int i = 0; i < time.size(); i++)
+		for (int b = 0; b < density.size(); b++)
+			out << time[i] << "," << b+1 << "," << density[b].mean[i] << ","
+				<< density[b].variance[i] << "\n";
+	return out.status() == QTextStream::Ok;
+}
+
+static bool writeSeries(const Model& model, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<qreal> time = model.getTime();
+	QVector<qreal> prob = model.getProb();
+	QVector<qreal> impulses = model.getImpulses();
+	out << "time,prob,impulses\n";
+	for (int i = 0; i < time.size(); i++)
+		out << time[i] << "," << prob[i] << "," << impulses[i] << "\n";
+	return out.status() == QTextStream::Ok;
+}
+
+static bool writeDensity(const Model& model, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<qreal> density = model.getDensity();
+	out << "bin,density\n";
+	for (int b = 0; b < density.size(); b++)
+		out << b+1 << "," << density[b] << "\n";
+	return out.status() == QTextStream::Ok;
+}
+
+// Warns when the random disordered atoms did not all fit
+static void checkAtoms(int atoms, int target, const QString& run)
+{
+	if (atoms < target)
+		fprintf(stderr, "Warning: %s placed %d of %d atoms, the density is lower than asked\n",
+				qPrintable(run), atoms, target);
+}
+
+// Disordered atoms of each model, one line per replica
+static bool writeAtoms(const QVector<const Model*>& models, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+
+	out << "replica,seed,atoms,target\n";
+	for (int r = 0; r < models.size(); r++) {
+		const Model *model = models[r];
+		out << r+1 << "," << model->getSeed() << "," << model->getScattererCount() << ","
+			<< model->getScattererTarget() << "\n";
+	}
+	return out.status() == QTextStream::Ok;
+}
+
+static bool writeDisplacements(const Model& model, const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	QVector<QPointF> displacements = model.getDisplacements();
+	out << "electron,dx,dy\n";
+	for (int i = 0; i < displacements.size(); i++)
+		out << i+1 << "," << displacements[i].x() << "," << displacements[i].y() << "\n";
+	return out.status() == QTextStream::Ok;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	Options opt;
+	if (!parse(app.arguments(), opt)) {
+		usage();
+		return 1;
+	}
+
+	QString seriesFile = opt.output + "_series.csv";
+	QString densityFile = opt.output + "_density.csv";
+	bool written;
+
+	if (opt.sides.size() > 1 || opt.atomRs.size() > 1 ||
+		opt.electronRs.size() > 1 || opt.speeds.size() > 1) {
+		Sweep sweep(opt.params);
+		sweep.setSides(opt.sides);
+		sweep.setAtomRs(opt.atomRs);
+		sweep.setElectronRs(opt.electronRs);
+		sweep.setSpeeds(opt.speeds);
+		sweep.run(opt.duration, opt.step);
+		written = writeSweep(sweep, opt.output + "_sweep.csv");
+
+		QVector<Sweep::Result> results = sweep.getResults();
+		for (int i = 0; i < results.size(); i++) {
+			const Parameters& p = results[i].params;
+			checkAtoms(results[i].atoms, results[i].atomsTarget,
+					   QString("side %1 atomR %2").arg(p.side).arg(p.atomR));
+		}
+	}
+	else if (opt.replicas > 1) {
+		Ensemble ensemble(opt.params, opt.replicas);
+		QVector<const Model*> replicas;
+		for (int r = 0; r < ensemble.getReplicas(); r++) {
+			const Model& model = ensemble.getReplica(r);
+			checkAtoms(model.getScattererCount(), model.getScattererTarget(), QString("replica %1").arg(r+1));
+			replicas.append(&model);
+		}
+
+		ensemble.run(opt.duration, opt.step);
+		written = writeSeries(ensemble, seriesFile) && writeDensity(ensemble, densityFile);
+		if (opt.params.geometry == Model::DisorderedGeometry)
+			written = writeAtoms(replicas, opt.output + "_atoms.csv") && written;
+	}
+	else {
+		Model model;
+		opt.params.apply(model);
+		checkAtoms(model.getScattererCount(), model.getScattererTarget(), "the run");
+
+		StreamWriter *stream = 0;
+		if (opt.stream == "csv")
+			stream = new StreamWriter(opt.output + "_stream.csv", StreamWriter::Csv);
+		else if (opt.stream == "binary")
+			stream = new StreamWriter(opt.output + "_stream.bin", StreamWriter::Binary);
+		if (stream && stream->isOpen())
+			model.setSink(stream);
+
+		for (int elapsed = 0; elapsed < opt.duration; elapsed += opt.step)
+			model.step(opt.step);
+		written = writeSeries(model, seriesFile) && writeDensity(model, densityFile);
+		if (opt.params.geometry == Model::DisorderedGeometry)
+			written = writeAtoms(QVector<const Model*>(1, &model), opt.output + "_atoms.csv") && written;
+		if (model.getBoundary() == Model::PeriodicBoundary) {
+			model.sync();
+			written = writeDisplacements(model, opt.output + "_displacement.csv") && written;
+		}
+
+		if (stream) {
+			written = stream->close() && written;
+			delete stream;
+		}
+	}
+
+	if (!written) {
+		fprintf(stderr, "Cannot write %s\n", qPrintable(opt.output));
+		return 1;
+	}
+	return 0;
+}
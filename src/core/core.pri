@@ -0,0 +1,34 @@
+# GUI-free physics core: the model state, the integrators and the
+# statistics.  Needs QtCore (and QtConcurrent on Qt 5) only.
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+HEADERS += $$PWD/model.h \
+           $$PWD/parameters.h \
+           $$PWD/ensemble.h \
+           $$PWD/sweep.h \
+           $$PWD/particles.h \
+           $$PWD/random.h \
+           $$PWD/freeflight.h \
+           $$PWD/measurementsink.h \
+           $$PWD/streamwriter.h \
+           $$PWD/lattice.h \
+           $$PWD/scatterers.h
+
+SOURCES += $$PWD/model.cpp \
+           $$PWD/parameters.cpp \
+           $$PWD/ensemble.cpp \
+           $$PWD/sweep.cpp \
+           $$PWD/particles.cpp \
+           $$PWD/random.cpp \
+           $$PWD/freeflight.cpp \
+           $$PWD/streamwriter.cpp \
+           $$PWD/scatterers.cpp
+
+# qmake CONFIG+=avx builds the free-flight kernel with AVX instead of SSE2
+avx {
+    QMAKE_CXXFLAGS += -mavx
+}
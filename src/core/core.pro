@@ -0,0 +1,9 @@
+# Builds the physics core alone as a static library
+QT -= gui
+
+TEMPLATE = lib
+CONFIG += staticlib
+
+TARGET = lorentzcore
+
+include(core.pri)
@@ -0,0 +1,140 @@
+#include <QtConcurrentMap>
+
+#include "ensemble.h"
+#include "model.h"
+
+namespace {
+
+struct RunTask {
+	typedef void result_type;
+
+	int duration;
+	int step;
+
+	void operator()(Model *model) const
+	{
+		for (int elapsed = 0; elapsed < duration; elapsed += step)
+			model->step(step);
+	}
+};
+
+}
+
+Ensemble::Ensemble(const Parameters& params, int replicas)
+{
+	Parameters p = params;
+	// replicas already fill the cores
+	p.threads = 1;
+	for (int r = 0; r < replicas; r++) {
+		p.seed = params.seed + r;
+		Model *model = new Model;
+		p.apply(*model);
+		models.append(model);
+	}
+}
+
+Ensemble::~Ensemble()
+{
+	qDeleteAll(models);
+}
+
+void Ensemble::run(int duration, int step)
+{
+	RunTask task;
+	task.duration = duration;
+	task.step = step;
+	QtConcurrent::blockingMap(models, task);
+}
+
+// Number of measurement points recorded by every replica
+int Ensemble::points() const
+{
+	if (models.isEmpty())
+		return 0;
+	int count = models[0]->getTime().size();
+	for (int r = 1; r < models.size(); r++)
+		count = qMin(count, models[r]->getTime().size());
+	return count;
+}
+
+/*
+ * Adds the values of the k-th replica, from 1, by Welford's update: the
+ * mean of the first k and the sum of squared deviations from it, kept in
+ * variance. Unlike the sum of squares minus n*mean^2, nothing cancels
+ * when the replicas nearly agree.
+ */
+void Ensemble::accumulate(Series& series, const QVector<qreal>& values, int count, int k)
+{
+	for (int i = 0; i < count; i++) {
+		qreal delta = values[i] - series.mean[i];
+		series.mean[i] += delta / k;
+		series.variance[i] += delta * (values[i] - series.mean[i]);
+	}
+}
+
+// Turns the sums of squared deviations into the sample variance
+void Ensemble::finish(Series& series) const
+{
+	int n = models.size();
+	for (int i = 0; i < series.variance.size(); i++)
+		series.variance[i] = n > 1 ? series.variance[i] / (n - 1) : 0;
+}
+
+QVector<qreal> Ensemble::getTime() const
+{
+	if (models.isEmpty())
+		return QVector<qreal>();
+	return models[0]->getTime().mid(0, points());
+}
+
+Ensemble::Series Ensemble::getProb() const
+{
+	int count = points();
+	Series series;
+	series.mean.fill(0, count);
+	series.variance.fill(0, count);
+	for (int r = 0; r < models.size(); r++)
+		accumulate(series, models[r]->getProb(), count, r + 1);
+	finish(series);
+	return series;
+}
+
+Ensemble::Series Ensemble::getPressure() const
+{
+	int count = points();
+	Series series;
+	series.mean.fill(0, count);
+	series.variance.fill(0, count);
+	for (int r = 0; r < models.size(); r++) {
+		QVector<qreal> time = models[r]->getTime();
+		QVector<qreal> pressure = models[r]->getImpulses();
+		for (int i = 0; i < count; i++)
+			pressure[i] /= time[i];
+		accumulate(series, pressure, count, r + 1);
+	}
+	finish(series);
+	return series;
+}
+
+QVector<Ensemble::Series> Ensemble::getDensity() const
+{
+	int count = points();
+	int nbins = models.isEmpty() ? 0 : models[0]->getBinsNumber();
+	QVector<Series> bins(nbins);
+	for (int b = 0; b < nbins; b++) {
+		bins[b].mean.fill(0, count);
+		bins[b].variance.fill(0, count);
+	}
+	QVector<qreal> values(count);
+	for (int r = 0; r < models.size(); r++) {
+		QVector<QVector<qreal> > densities = models[r]->getDensities();
+		for (int b = 0; b < nbins; b++) {
+			for (int i = 0; i < count; i++)
+				values[i] = densities[i][b];
+			accumulate(bins[b], values, count, r + 1);
+		}
+	}
+	for (int b = 0; b < nbins; b++)
+		finish(bins[b]);
+	return bins;
+}
@@ -0,0 +1,48 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <QVector>
+
+#include "parameters.h"
+
+class Model;
+
+/*
+ * Independent replicas of one model with different seeds, stepped in
+ * parallel.  Reports the mean and the sample variance over the replicas
+ * at each measurement point.
+ */
+class Ensemble
+{
+public:
+	struct Series {
+		QVector<qreal> mean;
+		QVector<qreal> variance;
+	};
+
+	// Replica r is seeded with params.seed + r
+	Ensemble(const Parameters& params, int replicas);
+	~Ensemble();
+
+	// Advances every replica by duration milliseconds in steps of step ms
+	void run(int duration, int step);
+
+	int getReplicas() const { return models.size(); }
+	const Model& getReplica(int r) const { return *models[r]; }
+	QVector<qreal> getTime() const;
+	Series getProb() const;
+	Series getPressure() const;
+	// Density in each bin, over the measurement points
+	QVector<Series> getDensity() const;
+
+private:
+	Q_DISABLE_COPY(Ensemble)
+
+	int points() const;
+	static void accumulate(Series& series, const QVector<qreal>& values, int count, int k);
+	void finish(Series& series) const;
+
+	QVector<Model*> models;
+};
+
+#endif
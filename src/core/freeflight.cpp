@@ -0,0 +1,70 @@
+#include "freeflight.h"
+
+// The vector paths assume qreal is double, which holds for every x86 Qt build
+// unless the coordinate type is overridden.
+#if !defined(QT_COORD_TYPE)
+#  if defined(__AVX__)
+#    include <immintrin.h>
+#    define FREEFLIGHT_AVX
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define FREEFLIGHT_SSE2
+#  endif
+#endif
+
+void advanceFree(qreal *x, qreal *y, const qreal *vx, const qreal *vy,
+				 qreal *px, qreal *py, uchar *out, int n, qreal s,
+				 qreal xmin, qreal xmax, qreal ymin, qreal ymax)
+{
+	int i = 0;
+
+#if defined(FREEFLIGHT_AVX)
+	const __m256d S = _mm256_set1_pd(s);
+	const __m256d XMIN = _mm256_set1_pd(xmin), XMAX = _mm256_set1_pd(xmax);
+	const __m256d YMIN = _mm256_set1_pd(ymin), YMAX = _mm256_set1_pd(ymax);
+	for (; i + 4 <= n; i += 4) {
+		__m256d X = _mm256_load_pd(x + i);
+		__m256d Y = _mm256_load_pd(y + i);
+		_mm256_storeu_pd(px + i, X);
+		_mm256_storeu_pd(py + i, Y);
+		X = _mm256_add_pd(X, _mm256_mul_pd(_mm256_load_pd(vx + i), S));
+		Y = _mm256_add_pd(Y, _mm256_mul_pd(_mm256_load_pd(vy + i), S));
+		__m256d outX = _mm256_or_pd(_mm256_cmp_pd(X, XMIN, _CMP_LT_OQ), _mm256_cmp_pd(X, XMAX, _CMP_GT_OQ));
+		__m256d outY = _mm256_or_pd(_mm256_cmp_pd(Y, YMIN, _CMP_LT_OQ), _mm256_cmp_pd(Y, YMAX, _CMP_GT_OQ));
+		int mask = _mm256_movemask_pd(_mm256_or_pd(outX, outY));
+		out[i] = mask & 1;
+		out[i+1] = (mask >> 1) & 1;
+		out[i+2] = (mask >> 2) & 1;
+		out[i+3] = (mask >> 3) & 1;
+		_mm256_store_pd(x + i, X);
+		_mm256_store_pd(y + i, Y);
+	}
+#elif defined(FREEFLIGHT_SSE2)
+	const __m128d S = _mm_set1_pd(s);
+	const __m128d XMIN = _mm_set1_pd(xmin), XMAX = _mm_set1_pd(xmax);
+	const __m128d YMIN = _mm_set1_pd(ymin), YMAX = _mm_set1_pd(ymax);
+	for (; i + 2 <= n; i += 2) {
+		__m128d X = _mm_load_pd(x + i);
+		__m128d Y = _mm_load_pd(y + i);
+		_mm_storeu_pd(px + i, X);
+		_mm_storeu_pd(py + i, Y);
+		X = _mm_add_pd(X, _mm_mul_pd(_mm_load_pd(vx + i), S));
+		Y = _mm_add_pd(Y, _mm_mul_pd(_mm_load_pd(vy + i), S));
+		__m128d outX = _mm_or_pd(_mm_cmplt_pd(X, XMIN), _mm_cmpgt_pd(X, XMAX));
+		__m128d outY = _mm_or_pd(_mm_cmplt_pd(Y, YMIN), _mm_cmpgt_pd(Y, YMAX));
+		int mask = _mm_movemask_pd(_mm_or_pd(outX, outY));
+		out[i] = mask & 1;
+		out[i+1] = (mask >> 1) & 1;
+		_mm_store_pd(x + i, X);
+		_mm_store_pd(y + i, Y);
+	}
+#endif
+
+	for (; i < n; i++) {
+		px[i] = x[i];
+		py[i] = y[i];
+		x[i] += vx[i] * s;
+		y[i] += vy[i] * s;
+		out[i] = x[i] < xmin || x[i] > xmax || y[i] < ymin || y[i] > ymax;
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef FREEFLIGHT_H
+#define FREEFLIGHT_H
+
+#include <QtGlobal>
+
+/*
+ * Moves n electrons by the path length s along their unit velocities.
+ * The positions before the move are written to px, py, and out[i] is set
+ * to 1 if electron i ended outside the box [xmin, xmax] x [ymin, ymax],
+ * 0 otherwise; the caller resolves the wall collisions of those.
+ *
+ * x, y, vx, vy must be aligned to Particles::alignment.
+ * Uses AVX when the compiler targets it (CONFIG+=avx), SSE2 otherwise.
+ */
+void advanceFree(qreal *x, qreal *y, const qreal *vx, const qreal *vy,
+				 qreal *px, qreal *py, uchar *out, int n, qreal s,
+				 qreal xmin, qreal xmax, qreal ymin, qreal ymax);
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef LATTICE_H
+#define LATTICE_H
+
+#include <QtGlobal>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <qmath.h>
+
+#include <limits>
+
+/*
+ * Lattice geometries of the atoms. Each is a policy with the same inline
+ * queries, used as a template parameter by the engines, so that the
+ * query of the chosen geometry is compiled into the step loops:
+ *
+ *   qreal nearest(x, y, xC, yC)       centre of the nearest atom and the
+ *                                     squared distance to it
+ *   bool overlaps(x, y, r)            an atom centre lies within r
+ *   qreal inradius()                  a disk of this radius around an atom
+ *                                     stays within the atom's Voronoi cell
+ *   bool firstHit(p, d, R, tMax, t, centre)
+ *                                     first disk of radius R hit by the ray
+ *                                     p + t*d (|d| = 1) with t < tMax
+ *   QVector<QPointF> centres(area)    atoms whose centre lies in area
+ *   qreal periodX(), periodY()        the atoms repeat with these periods
+ */
+
+/*
+ * Rectangular lattice of atoms centred at (x0 + i*sx, y0 + j*sy).
+ */
+class RectLattice
+{
+public:
+	RectLattice() : x0(0), y0(0), sx(1), sy(1) {}
+	RectLattice(qreal x0, qreal y0, qreal sx, qreal sy) : x0(x0), y0(y0), sx(sx), sy(sy) {}
+
+	// Indices of the cell, the rectangle of the spacing size centred on an atom
+	int cellX(qreal x) const { return qFloor((x - x0)/sx + 0.5); }
+	int cellY(qreal y) const { return qFloor((y - y0)/sy + 0.5); }
+
+	qreal centreX(int ix) const { return x0 + ix*sx; }
+	qreal centreY(int iy) const { return y0 + iy*sy; }
+
+	// Whenever some atom is within a distance, the nearest one is
+	qreal nearest(qreal x, qreal y, qreal& xC, qreal& yC) const
+	{
+		xC = centreX(cellX(x));
+		yC = centreY(cellY(y));
+		return (x-xC)*(x-xC) + (y-yC)*(y-yC);
+	}
+
+	bool overlaps(qreal x, qreal y, qreal r) const
+	{
+		qreal xC, yC;
+		return nearest(x, y, xC, yC) <= r*r;
+	}
+
+	qreal inradius() const { return qMin(sx, sy) / 2; }
+
+	qreal periodX() const { return sx; }
+	qreal periodY() const { return sy; }
+
+	// Walks the cells pierced by the ray and tests the atoms whose disk
+	// may reach the cell. Atoms the ray is leaving or already inside of
+	// are skipped.
+	bool firstHit(const QPointF& p, const QPointF& d, qreal R, qreal tMax, qreal& t, QPointF& centre) const
+	{
+		const qreal inf = std::numeric_limits<qreal>::infinity();
+		int reachX = qMax(0, qCeil(R/sx - 0.5));
+		int reachY = qMax(0, qCeil(R/sy - 0.5));
+
+		int cx = cellX(p.x());
+		int cy = cellY(p.y());
+		int stepX = d.x() > 0 ? 1 : -1;
+		int stepY = d.y() > 0 ? 1 : -1;
+		qreal tNextX = d.x() != 0 ? (centreX(cx) + 0.5*stepX*sx - p.x()) / d.x() : inf;
+		qreal tNextY = d.y() != 0 ? (centreY(cy) + 0.5*stepY*sy - p.y()) / d.y() : inf;
+		qreal tDeltaX = d.x() != 0 ? sx / qAbs(d.x()) : inf;
+		qreal tDeltaY = d.y() != 0 ? sy / qAbs(d.y()) : inf;
+
+		bool found = false;
+		t = tMax;
+		for (;;) {
+			for (int ix = cx - reachX; ix <= cx + reachX; ix++) {
+				for (int iy = cy - reachY; iy <= cy + reachY; iy++) {
+					QPointF c(centreX(ix), centreY(iy));
+					qreal rx = p.x() - c.x();
+					qreal ry = p.y() - c.y();
+					qreal b = rx*d.x() + ry*d.y();
+					qreal q = rx*rx + ry*ry - R*R;
+					if (b >= 0 || q <= 0)
+						continue;
+					qreal D = b*b - q;
+					if (D < 0)
+						continue;
+					qreal th = -b - qSqrt(D);
+					if (th < t) {
+						t = th;
+						centre = c;
+						found = true;
+					}
+				}
+			}
+			// nothing outside the visited cells can be hit before leaving them
+			if (t <= qMin(tNextX, tNextY))
+				return found;
+			if (tNextX < tNextY) {
+				cx += stepX;
+				tNextX += tDeltaX;
+			}
+			else {
+				cy += stepY;
+				tNextY += tDeltaY;
+			}
+		}
+	}
+
+	QVector<QPointF> centres(const QRectF& area) const
+	{
+		QVector<QPointF> list;
+		for (int iy = qCeil((area.top() - y0)/sy); centreY(iy) <= area.bottom(); iy++) {
+			for (int ix = qCeil((area.left() - x0)/sx); centreX(ix) <= area.right(); ix++)
+				list.append(QPointF(centreX(ix), centreY(iy)));
+		}
+		return list;
+	}
+
+private:
+	qreal x0, y0;
+	qreal sx, sy;
+};
+
+/*
+ * Square lattice of atoms at (xBegin + i*side, yBegin + j*side).
+ */
+class SquareLattice : public RectLattice
+{
+public:
+	SquareLattice() {}
+	SquareLattice(qreal xBegin, qreal yBegin, qreal side) : RectLattice(xBegin, yBegin, side, side) {}
+};
+
+/*
+ * Triangular lattice with the nearest atoms side apart, rows running
+ * along x from (xBegin, yBegin). Every atom is surrounded by a hexagon
+ * of six, which gives a finite horizon once the atoms are large enough.
+ * Made of two rectangular lattices of side by side*sqrt(3), the second
+ * shifted by half of that.
+ */
+class TriangularLattice
+{
+public:
+	TriangularLattice() {}
+	TriangularLattice(qreal xBegin, qreal yBegin, qreal side)
+		: even(xBegin, yBegin, side, side*qSqrt(3)),
+		  odd(xBegin + side/2, yBegin + side*qSqrt(3)/2, side, side*qSqrt(3)),
+		  side(side) {}
+
+	qreal nearest(qreal x, qreal y, qreal& xC, qreal& yC) const
+	{
+		qreal xO, yO;
+		qreal dE = even.nearest(x, y, xC, yC);
+		qreal dO = odd.nearest(x, y, xO, yO);
+		if (dO < dE) {
+			xC = xO;
+			yC = yO;
+			return dO;
+		}
+		return dE;
+	}
+
+	bool overlaps(qreal x, qreal y, qreal r) const
+	{
+		qreal xC, yC;
+		return nearest(x, y, xC, yC) <= r*r;
+	}
+
+	qreal inradius() const { return side / 2; }
+
+	qreal periodX() const { return even.periodX(); }
+	qreal periodY() const { return even.periodY(); }
+
+	bool firstHit(const QPointF& p, const QPointF& d, qreal R, qreal tMax, qreal& t, QPointF& centre) const
+	{
+		bool found = even.firstHit(p, d, R, tMax, t, centre);
+		qreal tOdd;
+		QPointF centreOdd;
+		if (odd.firstHit(p, d, R, t, tOdd, centreOdd)) {
+			t = tOdd;
+			centre = centreOdd;
+			found = true;
+		}
+		return found;
+	}
+
+	QVector<QPointF> centres(const QRectF& area) const
+	{
+		return even.centres(area) + odd.centres(area);
+	}
+
+private:
+	RectLattice even, odd;
+	qreal side;
+};
+
+#endif
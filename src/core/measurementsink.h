@@ -0,0 +1,21 @@
+#ifndef MEASUREMENTSINK_H
+#define MEASUREMENTSINK_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/*
+ * Receives every measurement of a Model as it is taken, see Model::setSink.
+ * Called from Model::step, so it should return quickly.
+ */
+class MeasurementSink
+{
+public:
+	virtual ~MeasurementSink() {}
+
+	// time, prob and impulses are the values appended to the series,
+	// density the normalised density in each bin
+	virtual void measure(qreal time, qreal prob, qreal impulses, const QVector<qreal>& density) = 0;
+};
+
+#endif
@@ -0,0 +1,970 @@
+#include <QThread>
+#include <QtConcurrentMap>
+#include <qmath.h>
+
+#include "model.h"
+#include "freeflight.h"
+#include "random.h"
+#include "measurementsink.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include <limits>
+
+const int Model::MAX_HISTORY = 100000;
+const qreal Model::timeStep = 1.0;
+const qreal Model::measurePeriod = 20.0;
+const int Model::minPartitionSize = 1024;
+const int Model::maxTrials = 100;
+
+#define sqr(x) ((x)*(x))
+
+Model::Model()
+{
+	// default parameters
+	side = 25;
+	atomR = 5;
+	electronR = 2;
+	speed = 100;
+
+	width = 0;
+	height = 0;
+	boundary = ReflectingBoundary;
+
+	num = 0;
+	nbins = 1;
+	bin = 0;
+	binwidth = 0;
+
+	paintTraceOnly = false;
+
+	engine = TimeStepEngine;
+	clock = 0;
+	eventsDirty = true;
+	threads = 0;
+	seed = 1;
+
+	historyPolicy = DownsampledHistory;
+	historyCapacity = MAX_HISTORY;
+	historyRevision = 0;
+	sink = 0;
+
+	geometry = SquareGeometry;
+	xBegin = (width % side) / 2;
+	yBegin = (height % side) / 2;
+	xBegin = xBegin ? xBegin : side;
+	yBegin = yBegin ? yBegin : side;
+	placeLattice();
+
+	clear();
+}
+
+void Model::add(int x, int y, qreal angle)
+{
+	sync();
+	qreal px = x;
+	qreal py = y;
+	if (boundary == PeriodicBoundary) {
+		px -= qFloor(px / boxWidth) * boxWidth;
+		py -= qFloor(py / boxHeight) * boxHeight;
+	}
+	particles.append(px, py, cos(angle), sin(angle));
+	originX.append(px);
+	originY.append(py);
+	flightTime.append(clock);
+	num++;
+	eventsDirty = true;
+}
+
+void Model::clear()
+{
+	time.clear();
+	prob.clear();
+	impulses.clear();
+	densities.clear();
+	historyRevision++;
+	density = QVector<qreal>(nbins, 0);
+	timeInsideAll = QVector<qreal>(nbins, 0);
+	timeFull = 0;
+	timeInside = 0;
+	impulseSum = 0;
+}
+
+int Model::getNumber() const
+{
+	return num;
+}
+
+QVector<qreal> Model::getTime() const
+{
+	return time;
+}
+
+QVector<qreal> Model::getProb() const
+{
+	return prob;
+}
+
+QVector<qreal> Model::getImpulses() const
+{
+	return impulses;
+}
+
+QVector<QVector<qreal> > Model::getDensities() const
+{
+	return densities;
+}
+
+Model::SeriesView Model::getSeries() const
+{
+	SeriesView view;
+	view.size = time.size();
+	view.revision = historyRevision;
+	view.time = time.constData();
+	view.prob = prob.constData();
+	view.impulses = impulses.constData();
+	return view;
+}
+
+QVector<qreal> Model::getDensity() const
+{
+	return density;
+}
+
+QVector<QPointF> Model::getDisplacements() const
+{
+	QVector<QPointF> list(num);
+	for (int i = 0; i < num; i++)
+		list[i] = QPointF(particles.x[i] - originX[i], particles.y[i] - originY[i]);
+	return list;
+}
+
+void Model::setNumber(int newNum)
+{
+	sync();
+	eventsDirty = true;
+
+	while (newNum < num) {
+		particles.pop();
+		originX.pop_back();
+		originY.pop_back();
+		flightTime.pop_back();
+		num--;
+	}
+	while (newNum > num) {
+		qreal x, y, angle;
+		drawElectron(num, x, y, angle);
+		particles.append(x, y, cos(angle), sin(angle));
+		originX.append(x);
+		originY.append(y);
+		flightTime.append(clock);
+		num++;
+	}
+}
+
+/*
+ * Random position and direction of electron i, drawn from the stream of
+ * its index. The position is drawn again while it overlaps an atom, up to
+ * maxTrials times.
+ */
+void Model::drawElectron(int i, qreal& x, qreal& y, qreal& angle) const
+{
+	Random random(seed, i);
+	for (int trial = 1; trial < maxTrials; trial++) {
+		x = random.uniform() * boxWidth;
+		y = random.uniform() * boxHeight;
+
+		if (!overlapsAtom(x, y, atomR + electronR))
+			break;
+	}
+	angle = 2*M_PI * random.uniform();
+}
+
+/*
+ * Places again the electrons that a change of the atoms, the radii or the
+ * dimensions left inside an atom, where the flights would pass through
+ * it, or beyond the walls. Those resting on an atom or a wall after a hit
+ * are left alone.
+ */
+void Model::releaseTrapped()
+{
+	const qreal eps = 1e-9;
+	qreal r = (atomR + electronR) * (1 - eps);
+	qreal xmin, xmax, ymin, ymax;
+	bounds(xmin, xmax, ymin, ymax);
+	for (int i = 0; i < num; i++) {
+		qreal x0 = particles.x[i];
+		qreal y0 = particles.y[i];
+		bool inside = x0 >= xmin - eps && x0 <= xmax + eps && y0 >= ymin - eps && y0 <= ymax + eps;
+		if (inside && !overlapsAtom(x0, y0, r))
+			continue;
+		qreal x, y, angle;
+		drawElectron(i, x, y, angle);
+		particles.x[i] = x;
+		particles.y[i] = y;
+		particles.vx[i] = cos(angle);
+		particles.vy[i] = sin(angle);
+		originX[i] = x;
+		originY[i] = y;
+		flightTime[i] = clock;
+	}
+}
+
+void Model::follow(const Model& other, int first)
+{
+	width = other.width;
+	height = other.height;
+	xBegin = other.xBegin;
+	yBegin = other.yBegin;
+	side = other.side;
+	geometry = other.geometry;
+	square = other.square;
+	triangular = other.triangular;
+	disordered = other.disordered;
+	scatterers = other.scatterers;
+	scattererTarget = other.scattererTarget;
+	atomR = other.atomR;
+	electronR = other.electronR;
+	speed = other.speed;
+	boundary = other.boundary;
+	boxWidth = other.boxWidth;
+	boxHeight = other.boxHeight;
+	engine = other.engine;
+	threads = other.threads;
+	seed = other.seed;
+	nbins = other.nbins;
+	bin = other.bin;
+	binwidth = other.binwidth;
+	clock = other.clock;
+
+	// as other holds them, those the event-driven engine has not moved yet too
+	first = qBound(0, first, other.num);
+	num = other.num - first;
+	const Particles& p = other.particles;
+	particles.clear();
+	originX = QVector<qreal>(num);
+	originY = QVector<qreal>(num);
+	flightTime = QVector<qreal>(num);
+	for (int i = 0; i < num; i++) {
+		particles.append(p.x[first + i], p.y[first + i], p.vx[first + i], p.vy[first + i]);
+		originX[i] = other.originX[first + i];
+		originY[i] = other.originY[first + i];
+		flightTime[i] = other.flightTime[first + i];
+	}
+	eventsDirty = true;
+	clear();
+}
+
+void Model::setSide(int val)
+{
+	sync();
+	side = val;
+	placeLattice();
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setGeometry(Geometry g)
+{
+	sync();
+	geometry = g;
+	placeLattice();
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setBoundary(Boundary b)
+{
+	sync();
+	boundary = b;
+	placeScatterers();
+	placeBox();
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setScatterers(const QVector<QPointF>& centres)
+{
+	sync();
+	scatterers = centres;
+	placeScatterers();
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setAtomR(qreal val)
+{
+	sync();
+	atomR = val;
+	placeScatterers();
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setElectronR(qreal val)
+{
+	sync();
+	electronR = val;
+	releaseTrapped();
+	eventsDirty = true;
+}
+
+void Model::setSpeed(qreal val)
+{
+	speed = val;
+}
+
+void Model::setBinsNumber(int num)
+{
+	nbins = num;
+	binwidth = boxWidth / nbins;
+	density = QVector<qreal>(nbins, 0);
+	timeInsideAll = QVector<qreal>(nbins, 0);
+}
+
+void Model::setBinIndex(int idx)
+{
+	bin = idx;
+}
+
+void Model::setEngine(Engine e)
+{
+	if (e == engine)
+		return;
+	sync();
+	engine = e;
+	flightTime.fill(clock);
+	eventsDirty = true;
+}
+
+void Model::setSeed(quint32 val)
+{
+	seed = val;
+	if (geometry == DisorderedGeometry && scatterers.isEmpty()) {
+		sync();
+		placeScatterers();
+		releaseTrapped();
+		eventsDirty = true;
+	}
+}
+
+void Model::setThreads(int val)
+{
+	sync();
+	threads = val;
+}
+
+void Model::setDim(int w, int h)
+{
+	sync();
+	eventsDirty = true;
+
+	width = w;
+	height = h;
+
+	xBegin = (width % side) / 2;
+	yBegin = (height % side) / 2;
+	xBegin = xBegin ? xBegin : side;
+	yBegin = yBegin ? yBegin : side;
+	placeLattice();
+	releaseTrapped();
+}
+
+// Lays the atoms out from (xBegin, yBegin), side apart
+void Model::placeLattice()
+{
+	square = SquareLattice(xBegin, yBegin, side);
+	triangular = TriangularLattice(xBegin, yBegin, side);
+	placeScatterers();
+	placeBox();
+}
+
+/*
+ * Buckets the disordered atoms in cells of about the mean spacing, and at
+ * least a diameter. Random ones come at the density of the square lattice.
+ */
+void Model::placeScatterers()
+{
+	if (geometry != DisorderedGeometry) {
+		disordered = ScattererGrid();
+		scattererTarget = 0;
+		return;
+	}
+	bool periodic = boundary == PeriodicBoundary;
+	QVector<QPointF> centres = scatterers;
+	scattererTarget = centres.size();
+	if (centres.isEmpty()) {
+		scattererTarget = (width/side)*(height/side);
+		centres = ScattererGrid::scatter(scattererTarget, 2*atomR, width, height, periodic, seed);
+	}
+	qreal spacing = centres.isEmpty() ? side : qSqrt((qreal)width*height / centres.size());
+	disordered = ScattererGrid(centres, width, height, qMax(spacing, 2*atomR), periodic);
+}
+
+/*
+ * Sizes the box of the positions and the bins over it. A periodic box
+ * takes whole periods of the geometry, so that an electron wrapped across
+ * it meets the same atoms; the electrons are wrapped into it.
+ */
+void Model::placeBox()
+{
+	boxWidth = width;
+	boxHeight = height;
+	if (boundary == PeriodicBoundary) {
+		qreal px, py;
+		switch (geometry) {
+		case TriangularGeometry:
+			px = triangular.periodX();
+			py = triangular.periodY();
+			break;
+		case DisorderedGeometry:
+			px = disordered.periodX();
+			py = disordered.periodY();
+			break;
+		default:
+			px = square.periodX();
+			py = square.periodY();
+			break;
+		}
+		boxWidth = px * qMax(1, qFloor(width / px));
+		boxHeight = py * qMax(1, qFloor(height / py));
+
+		for (int i = 0; i < num; i++) {
+			qreal sx = qFloor(particles.x[i] / boxWidth) * boxWidth;
+			qreal sy = qFloor(particles.y[i] / boxHeight) * boxHeight;
+			particles.x[i] -= sx;
+			particles.y[i] -= sy;
+			originX[i] -= sx;
+			originY[i] -= sy;
+		}
+	}
+	binwidth = boxWidth / nbins;
+}
+
+bool Model::overlapsAtom(qreal x, qreal y, qreal r) const
+{
+	switch (geometry) {
+	case TriangularGeometry:
+		return triangular.overlaps(x, y, r);
+	case DisorderedGeometry:
+		return disordered.overlaps(x, y, r);
+	default:
+		return square.overlaps(x, y, r);
+	}
+}
+
+QVector<QPointF> Model::getAtomCentres() const
+{
+	QRectF area(-atomR, -atomR, width + 2*atomR, height + 2*atomR);
+	switch (geometry) {
+	case TriangularGeometry:
+		return triangular.centres(area);
+	case DisorderedGeometry:
+		return disordered.centres(area);
+	default:
+		return square.centres(area);
+	}
+}
+
+void Model::setPaintTraceOnly(bool set)
+{
+	paintTraceOnly = set;
+}
+
+void Model::setSink(MeasurementSink *newSink)
+{
+	sink = newSink;
+}
+
+void Model::setHistory(HistoryPolicy policy, int capacity)
+{
+	historyPolicy = policy;
+	historyCapacity = qMax(capacity, 4);
+	while (time.size() >= historyCapacity)
+		trimHistory();
+	historyRevision++;
+}
+
+/*
+ * Makes room in the full history. The ring drops the oldest quarter of
+ * the points; downsampling keeps every second point of the older half,
+ * so the older the points the coarser they get.
+ */
+void Model::trimHistory()
+{
+	int n = time.size();
+	int k = 0;
+	if (historyPolicy == RingHistory) {
+		for (int i = n/4; i < n; i++, k++) {
+			time[k] = time[i];
+			prob[k] = prob[i];
+			impulses[k] = impulses[i];
+			densities[k] = densities[i];
+		}
+	}
+	else {
+		for (int i = 0; i < n; i += (i < n/2 ? 2 : 1), k++) {
+			time[k] = time[i];
+			prob[k] = prob[i];
+			impulses[k] = impulses[i];
+			densities[k] = densities[i];
+		}
+	}
+	time.resize(k);
+	prob.resize(k);
+	impulses.resize(k);
+	densities.resize(k);
+	historyRevision++;
+}
+
+int Model::binOf(qreal x) const
+{
+	return qBound(0, qFloor(x / binwidth), nbins - 1);
+}
+
+/*
+ * Credits the time spent on a straight flight segment to the bins it
+ * passes through, in proportion to the x extent covered in each bin.
+ */
+void Model::accountSegment(Tally& tally, qreal x0, qreal x1, qreal length) const
+{
+	if (paintTraceOnly)
+		return;
+
+	qreal weight = length / num;
+	int b0 = binOf(x0);
+	int b1 = binOf(x1);
+	if (b0 == b1) {
+		tally.timeInsideAll[b0] += weight;
+		if (b0 == bin)
+			tally.timeInside += weight;
+		return;
+	}
+
+	if (x0 > x1) {
+		qSwap(x0, x1);
+		qSwap(b0, b1);
+	}
+	qreal perX = weight / (x1 - x0);
+	qreal from = x0;
+	for (int b = b0; b <= b1; b++) {
+		qreal to = b < b1 ? (b+1)*binwidth : x1;
+		qreal w = (to - from) * perX;
+		tally.timeInsideAll[b] += w;
+		if (b == bin)
+			tally.timeInside += w;
+		from = to;
+	}
+}
+
+/*
+ * Splits the electrons into contiguous ranges, one per thread. Range
+ * starts are multiples of 4 to keep the SIMD columns aligned.
+ */
+void Model::preparePartitions()
+{
+	int count = threads > 0 ? threads : QThread::idealThreadCount();
+	count = qBound(1, count, (num + minPartitionSize - 1) / minPartitionSize);
+	if (partitions.size() == count && partitions.last().end == num)
+		return;
+
+	int chunk = ((num + count - 1) / count + 3) & ~3;
+	partitions.resize(count);
+	for (int k = 0; k < count; k++) {
+		Partition& part = partitions[k];
+		part.begin = qMin(k*chunk, num);
+		part.end = qMin((k+1)*chunk, num);
+		part.events = std::priority_queue<Event>();
+	}
+	eventsDirty = true;
+}
+
+void Model::PassTask::operator()(Partition& part) const
+{
+	Tally& tally = part.tally;
+	tally.timeInside = 0;
+	tally.impulseSum = 0;
+	tally.timeInsideAll.fill(0, model->nbins);
+
+	// the geometry is chosen once per pass, the engines are compiled for each
+	switch (pass) {
+	case TimedPass:
+		if (model->geometry == TriangularGeometry)
+			model->stepTimed(model->triangular, part, arg);
+		else if (model->geometry == DisorderedGeometry)
+			model->stepTimed(model->disordered, part, arg);
+		else
+			model->stepTimed(model->square, part, arg);
+		break;
+	case EventsPass:
+		if (model->geometry == TriangularGeometry)
+			model->stepEvents(model->triangular, part, arg);
+		else if (model->geometry == DisorderedGeometry)
+			model->stepEvents(model->disordered, part, arg);
+		else
+			model->stepEvents(model->square, part, arg);
+		break;
+	case SyncPass:
+		model->syncPartition(part);
+		break;
+	}
+}
+
+/*
+ * Runs the pass over all partitions in parallel, then adds up their
+ * statistics in partition order so that the sums do not depend on
+ * thread scheduling.
+ */
+void Model::runPass(Pass pass, qreal arg)
+{
+	preparePartitions();
+
+	columns.prevX = prevX.data();
+	columns.prevY = prevY.data();
+	columns.outside = outside.data();
+	columns.originX = originX.data();
+	columns.originY = originY.data();
+	columns.flightTime = flightTime.data();
+
+	PassTask task;
+	task.model = this;
+	task.pass = pass;
+	task.arg = arg;
+	if (partitions.size() == 1)
+		task(partitions[0]);
+	else
+		QtConcurrent::blockingMap(partitions, task);
+	if (pass == EventsPass)
+		eventsDirty = false;
+
+	if (paintTraceOnly)
+		return;
+	for (int k = 0; k < partitions.size(); k++) {
+		const Tally& tally = partitions[k].tally;
+		timeInside += tally.timeInside;
+		impulseSum += tally.impulseSum;
+		for (int b = 0; b < nbins; ++b)
+			timeInsideAll[b] += tally.timeInsideAll[b];
+	}
+}
+
+template <class L>
+void Model::stepTimed(const L& lattice, Partition& part, qreal s)
+{
+	int n = part.end - part.begin;
+	int b = part.begin;
+	qreal xmin, xmax, ymin, ymax;
+	bounds(xmin, xmax, ymin, ymax);
+	advanceFree(particles.x + b, particles.y + b, particles.vx + b, particles.vy + b,
+				columns.prevX + b, columns.prevY + b, columns.outside + b, n, s,
+				xmin, xmax, ymin, ymax);
+
+	// when the atoms do not reach beyond their Voronoi cells, a straight
+	// path within one cell can only hit the atom of that cell
+	const qreal R = atomR + electronR;
+	bool cellLocal = R <= lattice.inradius();
+
+	for (int i = part.begin; i < part.end; i++) {
+		qreal x0 = columns.prevX[i];
+		qreal y0 = columns.prevY[i];
+		if (!columns.outside[i] && cellLocal) {
+			qreal xC, yC, xE, yE;
+			lattice.nearest(x0, y0, xC, yC);
+			lattice.nearest(particles.x[i], particles.y[i], xE, yE);
+			if (xC == xE && yC == yE) {
+				// closest approach to the centre along the path
+				qreal rx = x0 - xC;
+				qreal ry = y0 - yC;
+				qreal t = qBound((qreal)0, -(rx*particles.vx[i] + ry*particles.vy[i]), s);
+				if (sqr(rx + t*particles.vx[i]) + sqr(ry + t*particles.vy[i]) > sqr(R)) {
+					accountSegment(part.tally, x0, particles.x[i], s);
+					continue;
+				}
+			}
+		}
+		particles.x[i] = x0;
+		particles.y[i] = y0;
+		fly(lattice, part.tally, i, s);
+	}
+}
+
+/*
+ * Flies electron i over the path length s through all the collisions on
+ * the way, in time order, as the event-driven engine would.
+ */
+template <class L>
+void Model::fly(const L& lattice, Tally& tally, int i, qreal s)
+{
+	QPointF p(particles.x[i], particles.y[i]);
+	QPointF d(particles.vx[i], particles.vy[i]);
+
+	for (;;) {
+		qreal t;
+		Event::Kind kind;
+		QPointF centre;
+		bool hit = nextHit(lattice, p, d, s, t, kind, centre);
+		QPointF q = p + d*t;
+		accountSegment(tally, p.x(), q.x(), t);
+		p = q;
+		s -= t;
+		if (!hit)
+			break;
+		tally.impulseSum += collide(kind, i, p, centre, d);
+	}
+
+	particles.x[i] = p.x();
+	particles.y[i] = p.y();
+	particles.vx[i] = d.x();
+	particles.vy[i] = d.y();
+}
+
+/*
+ * Box of the electron centres: an electron radius in from the walls, or
+ * the periodic box.
+ */
+void Model::bounds(qreal& xmin, qreal& xmax, qreal& ymin, qreal& ymax) const
+{
+	if (boundary == PeriodicBoundary) {
+		xmin = ymin = 0;
+		xmax = boxWidth;
+		ymax = boxHeight;
+	}
+	else {
+		xmin = ymin = electronR;
+		xmax = width - electronR;
+		ymax = height - electronR;
+	}
+}
+
+/*
+ * Finds the first collision, with an edge of the box or an atom, of the
+ * ray p + t*d (|d| = 1) with t < tMax. Otherwise returns false and t = tMax.
+ */
+template <class L>
+bool Model::nextHit(const L& lattice, const QPointF& p, const QPointF& d, qreal tMax,
+					qreal& t, Event::Kind& kind, QPointF& centre) const
+{
+	const qreal inf = std::numeric_limits<qreal>::infinity();
+	qreal xmin, xmax, ymin, ymax;
+	bounds(xmin, xmax, ymin, ymax);
+
+	qreal tx = inf, ty = inf;
+	if (d.x() > 0)
+		tx = (xmax - p.x()) / d.x();
+	else if (d.x() < 0)
+		tx = (xmin - p.x()) / d.x();
+	if (d.y() > 0)
+		ty = (ymax - p.y()) / d.y();
+	else if (d.y() < 0)
+		ty = (ymin - p.y()) / d.y();
+
+	if (tx < ty) {
+		kind = Event::WallX;
+		t = qMax(tx, (qreal)0);
+	}
+	else {
+		kind = Event::WallY;
+		t = qMax(ty, (qreal)0);
+	}
+	bool found = t < tMax;
+	if (!found)
+		t = tMax;
+
+	qreal tAtom;
+	if (lattice.firstHit(p, d, atomR + electronR, t, tAtom, centre)) {
+		kind = Event::Atom;
+		t = tAtom;
+		found = true;
+	}
+	return found;
+}
+
+/*
+ * Reflects the velocity d off the wall or the atom at centre, hit at p.
+ * Returns the normal speed for a wall, 0 for an atom.
+ */
+qreal Model::reflect(Event::Kind kind, const QPointF& p, const QPointF& centre, QPointF& d)
+{
+	if (kind == Event::WallX) {
+		d.setX(-d.x());
+		return qAbs(d.x());
+	}
+	if (kind == Event::WallY) {
+		d.setY(-d.y());
+		return qAbs(d.y());
+	}
+
+	qreal nx = p.x() - centre.x();
+	qreal ny = p.y() - centre.y();
+	qreal nl = sqrt(sqr(nx) + sqr(ny));
+	nx /= nl;
+	ny /= nl;
+	qreal dn = d.x()*nx + d.y()*ny;
+	d = QPointF(d.x() - 2*dn*nx, d.y() - 2*dn*ny);
+	return 0;
+}
+
+/*
+ * Resolves the hit of electron i at p, the one rule of both engines.
+ * Returns the impulse registered: the momentum transfer 2|v_n| of the
+ * unit mass for a wall, nothing for an atom or a periodic edge.
+ */
+qreal Model::collide(Event::Kind kind, int i, QPointF& p, const QPointF& centre, QPointF& d)
+{
+	if (kind != Event::Atom && boundary == PeriodicBoundary) {
+		cross(kind, i, p, d);
+		return 0;
+	}
+	return 2*reflect(kind, p, centre, d);
+}
+
+/*
+ * Carries electron i, at p on the edge of the periodic box it is leaving
+ * along d, to the opposite edge. Its origin moves along, which keeps the
+ * displacement unwrapped.
+ */
+void Model::cross(Event::Kind kind, int i, QPointF& p, const QPointF& d)
+{
+	if (kind == Event::WallX) {
+		qreal shift = d.x() > 0 ? -boxWidth : boxWidth;
+		p.setX(p.x() + shift);
+		columns.originX[i] += shift;
+	}
+	else {
+		qreal shift = d.y() > 0 ? -boxHeight : boxHeight;
+		p.setY(p.y() + shift);
+		columns.originY[i] += shift;
+	}
+}
+
+template <class L>
+void Model::schedule(const L& lattice, Partition& part, int i)
+{
+	QPointF p(particles.x[i], particles.y[i]);
+	QPointF d(particles.vx[i], particles.vy[i]);
+
+	Event e;
+	e.electron = i;
+	nextHit(lattice, p, d, std::numeric_limits<qreal>::infinity(), e.time, e.kind, e.centre);
+	e.time += columns.flightTime[i];
+	part.events.push(e);
+}
+
+template <class L>
+void Model::stepEvents(const L& lattice, Partition& part, qreal target)
+{
+	std::priority_queue<Event>& events = part.events;
+	if (eventsDirty) {
+		events = std::priority_queue<Event>();
+		for (int i = part.begin; i < part.end; i++)
+			schedule(lattice, part, i);
+	}
+
+	while (!events.empty() && events.top().time <= target) {
+		Event e = events.top();
+		events.pop();
+
+		int i = e.electron;
+		qreal dt = e.time - columns.flightTime[i];
+		QPointF d(particles.vx[i], particles.vy[i]);
+		QPointF p(particles.x[i] + d.x()*dt, particles.y[i] + d.y()*dt);
+		accountSegment(part.tally, particles.x[i], p.x(), dt);
+
+		part.tally.impulseSum += collide(e.kind, i, p, e.centre, d);
+
+		particles.x[i] = p.x();
+		particles.y[i] = p.y();
+		particles.vx[i] = d.x();
+		particles.vy[i] = d.y();
+		columns.flightTime[i] = e.time;
+		schedule(lattice, part, i);
+	}
+}
+
+/*
+ * The event-driven engine moves an electron only when it collides.
+ * Brings every electron to the current clock along its free flight.
+ */
+void Model::sync()
+{
+	if (engine == EventDrivenEngine)
+		runPass(SyncPass, 0);
+}
+
+void Model::syncPartition(Partition& part)
+{
+	for (int i = part.begin; i < part.end; i++) {
+		qreal dt = clock - columns.flightTime[i];
+		if (dt <= 0)
+			continue;
+		qreal x = particles.x[i] + particles.vx[i]*dt;
+		accountSegment(part.tally, particles.x[i], x, dt);
+		particles.x[i] = x;
+		particles.y[i] += particles.vy[i]*dt;
+		columns.flightTime[i] = clock;
+	}
+}
+
+void Model::step(int elapsed)
+{
+	qreal s = speed * elapsed / 1000;
+
+	if (engine == EventDrivenEngine) {
+		runPass(EventsPass, clock + s);
+		clock += s;
+	}
+	else {
+		prevX.resize(num);
+		prevY.resize(num);
+		outside.resize(num);
+		runPass(TimedPass, s);
+	}
+
+	if (!paintTraceOnly)
+		timeFull += s;
+
+	if (time.empty() || (time.back() + measurePeriod <= timeFull)) {
+		sync();
+		if (time.size() >= historyCapacity)
+			trimHistory();
+		time.push_back(timeFull/100.0);
+		prob.push_back(timeInside/timeFull);
+		impulses.push_back(impulseSum);
+		qreal psum = 0;
+		for (int b = 0; b < nbins; ++b) {
+			density[b] = timeInsideAll[b] / timeFull;
+			psum += density[b];
+		}
+		for (int b = 0; b < nbins; ++b)
+			density[b] /= psum;
+		densities.push_back(density);
+		if (sink && !paintTraceOnly)
+			sink->measure(time.back(), prob.back(), impulseSum, density);
+	}
+}
+
+
+void Model::save()
+{
+	sync();
+	particles_save = particles;
+	originX_save = originX;
+	originY_save = originY;
+	clock_save = clock;
+	flightTime_save = flightTime;
+}
+
+void Model::load()
+{
+	particles = particles_save;
+	originX = originX_save;
+	originY = originY_save;
+	clock = clock_save;
+	flightTime = flightTime_save;
+	eventsDirty = true;
+}
+
+
@@ -0,0 +1,301 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+#include <QtGlobal>
+#include <QPointF>
+#include <QVector>
+
+#include <queue>
+
+#include "particles.h"
+#include "lattice.h"
+#include "scatterers.h"
+
+class MeasurementSink;
+
+class Model
+{
+public:
+	enum Engine {
+		TimeStepEngine,		// fixed steps, each flown through all its collisions
+		EventDrivenEngine	// jumps from one exact collision to the next
+	};
+
+	// Layout of the atoms, side apart or as many as the square lattice has
+	enum Geometry {
+		SquareGeometry,
+		TriangularGeometry,	// hexagonal packing, finite horizon for large atoms
+		DisorderedGeometry	// atoms at random or given positions
+	};
+
+	// What the electrons meet at the edges of the field
+	enum Boundary {
+		ReflectingBoundary,	// walls, registering the impulses
+		PeriodicBoundary	// an electron leaving the box comes back through the
+							// opposite edge, as in an infinite geometry
+	};
+
+	// How the measured series are kept within the history capacity
+	enum HistoryPolicy {
+		RingHistory,		// keeps the latest points, dropping the oldest quarter when full
+		DownsampledHistory	// halves the resolution of the older half when full
+	};
+
+	// Measured series; points are appended until the history is trimmed
+	// or cleared, which changes the revision.
+	// The pointers stay valid until the next step or clear().
+	struct SeriesView {
+		int size;
+		int revision;
+		const qreal *time;
+		const qreal *prob;
+		const qreal *impulses;
+	};
+
+	Model();
+
+public:
+	void step(int elapsed);
+	void add(int x, int y, qreal angle);
+	void clear();
+
+	void setDim(int w, int h);
+
+	int getNumber() const;
+	QVector<qreal> getTime() const;
+	QVector<qreal> getProb() const;
+	QVector<qreal> getImpulses() const;
+	QVector<qreal> getDensity() const;
+	// Density at each point of the series, as getDensity() was then
+	QVector<QVector<qreal> > getDensities() const;
+	SeriesView getSeries() const;
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getSide() const { return side; }
+	qreal getAtomR() const { return atomR; }
+	qreal getElectronR() const { return electronR; }
+	Geometry getGeometry() const { return geometry; }
+	Boundary getBoundary() const { return boundary; }
+	// Extent of the positions, the field or the periodic box
+	qreal getBoxWidth() const { return boxWidth; }
+	qreal getBoxHeight() const { return boxHeight; }
+	// Centres of the atoms reaching into the field
+	QVector<QPointF> getAtomCentres() const;
+	int getBinsNumber() const { return nbins; }
+	int getBinIndex() const { return bin; }
+	qreal getBinWidth() const { return binwidth; }
+	const Particles& getParticles() const { return particles; }
+	// Displacement of each electron since it was placed, unwrapped across
+	// the periodic box; up to date after sync()
+	QVector<QPointF> getDisplacements() const;
+
+	void setNumber(int newNum);
+	// Takes the parameters and the atoms of other and its electrons from
+	// first on, with fresh measurements. The electrons are copied into
+	// buffers of their own, so that other is left untouched.
+	void follow(const Model& other, int first);
+
+	// Changes of the atoms, the radii or the dimensions place the electrons
+	// they leave inside an atom again, as setNumber does
+	void setSide(int);
+	void setGeometry(Geometry);
+
+	// The periodic box is the largest whole number of periods of the
+	// geometry that fits in the field; electrons outside are wrapped into it
+	void setBoundary(Boundary);
+
+	// Positions of the atoms of DisorderedGeometry. With none, as many atoms
+	// as the square lattice has are drawn from the seed, not overlapping,
+	// and drawn again when the side, the atom radius, the dimensions, the
+	// seed or the boundary change. Fewer are placed when they do not fit.
+	void setScatterers(const QVector<QPointF>& centres);
+	// Atoms of DisorderedGeometry in place and the number asked for,
+	// 0 for the lattices
+	int getScattererCount() const { return disordered.size(); }
+	int getScattererTarget() const { return scattererTarget; }
+	void setSpeed(qreal);
+	void setAtomR(qreal);
+	void setElectronR(qreal);
+	void setBinsNumber(int);
+	void setBinIndex(int);
+	void setPaintTraceOnly(bool);
+
+	// At most capacity points are kept, MAX_HISTORY by default
+	void setHistory(HistoryPolicy policy, int capacity);
+	HistoryPolicy getHistoryPolicy() const { return historyPolicy; }
+	int getHistoryCapacity() const { return historyCapacity; }
+
+	// Every measurement is also passed to sink, 0 for none.
+	// The sink is not owned; copies of the model share it.
+	void setSink(MeasurementSink *sink);
+	MeasurementSink *getSink() const { return sink; }
+
+	void save();
+	void load();
+
+	// Brings the positions up to date, the event-driven engine
+	// moves electrons lazily
+	void sync();
+
+	void setEngine(Engine);
+	Engine getEngine() const { return engine; }
+
+	// Number of worker threads stepping the electrons, 0 for the ideal count.
+	// Results are reproducible for a fixed thread count.
+	void setThreads(int);
+	int getThreads() const { return threads; }
+
+	// Seed of the initial conditions; electron i is placed from stream i
+	// of the generator, whatever the order of the calls
+	void setSeed(quint32);
+	quint32 getSeed() const { return seed; }
+
+	static const qreal timeStep;
+	static const qreal measurePeriod;
+	static const int MAX_HISTORY;
+	static const int minPartitionSize;
+	static const int maxTrials;	// draws of a position clear of the atoms
+
+private:
+	Q_DISABLE_COPY(Model)
+
+	// Collision scheduled by the event-driven engine
+	struct Event {
+		enum Kind { Atom, WallX, WallY };
+
+		qreal time;		// clock value of the hit
+		int electron;
+		Kind kind;
+		QPointF centre;	// atom centre for Kind == Atom
+
+		// std::priority_queue is a max-heap, the earliest event must be on top
+		bool operator<(const Event& other) const { return time > other.time; }
+	};
+
+	// Statistics gathered by one partition during a pass
+	struct Tally {
+		qreal timeInside;
+		qreal impulseSum;
+		QVector<qreal> timeInsideAll;
+	};
+
+	// Contiguous range of electrons stepped by one thread
+	struct Partition {
+		int begin, end;
+		Tally tally;
+		std::priority_queue<Event> events;
+	};
+
+	enum Pass { TimedPass, EventsPass, SyncPass };
+
+	// Raw data of the per-electron vectors, taken by runPass on the calling
+	// thread; the passes index these, as indexing a vector from the worker
+	// threads could detach it several times at once
+	struct Columns {
+		qreal *prevX, *prevY;
+		uchar *outside;
+		qreal *originX, *originY;
+		qreal *flightTime;
+	};
+
+	// Runs one pass over a partition, used with QtConcurrent::blockingMap
+	struct PassTask {
+		typedef void result_type;
+
+		Model *model;
+		Pass pass;
+		qreal arg;
+
+		void operator()(Partition& part) const;
+	};
+
+	int binOf(qreal x) const;
+	void accountSegment(Tally& tally, qreal x0, qreal x1, qreal length) const;
+
+	void preparePartitions();
+	void runPass(Pass pass, qreal arg);
+	void syncPartition(Partition& part);
+	static qreal reflect(Event::Kind kind, const QPointF& p, const QPointF& centre, QPointF& d);
+	qreal collide(Event::Kind kind, int i, QPointF& p, const QPointF& centre, QPointF& d);
+	void cross(Event::Kind kind, int i, QPointF& p, const QPointF& d);
+	void bounds(qreal& xmin, qreal& xmax, qreal& ymin, qreal& ymax) const;
+	void placeLattice();
+	void placeScatterers();
+	void placeBox();
+	void drawElectron(int i, qreal& x, qreal& y, qreal& angle) const;
+	void releaseTrapped();
+	bool overlapsAtom(qreal x, qreal y, qreal r) const;
+
+	// Engines, compiled for each lattice geometry L
+	template <class L> void stepTimed(const L& lattice, Partition& part, qreal s);
+	template <class L> void stepEvents(const L& lattice, Partition& part, qreal target);
+	template <class L> void schedule(const L& lattice, Partition& part, int i);
+	template <class L> void fly(const L& lattice, Tally& tally, int i, qreal s);
+	template <class L> bool nextHit(const L& lattice, const QPointF& p, const QPointF& d, qreal tMax,
+									qreal& t, Event::Kind& kind, QPointF& centre) const;
+	void trimHistory();
+
+	int width;
+	int height;
+
+	int xBegin;
+	int yBegin;
+
+	int side;
+	Geometry geometry;
+	SquareLattice square;
+	TriangularLattice triangular;
+	ScattererGrid disordered;
+	QVector<QPointF> scatterers;	// given positions of the disordered atoms
+	int scattererTarget;
+	qreal atomR;
+	qreal electronR;
+	qreal speed;
+
+	Boundary boundary;
+	qreal boxWidth, boxHeight;
+
+	int num;
+	Particles particles;
+	QVector<qreal> originX, originY;	// starting point of electron i, shifted along with its wraps
+	QVector<qreal> prevX, prevY;	// positions before the current step
+	QVector<uchar> outside;		// set if the free flight left the box
+
+	Particles particles_save;
+	QVector<qreal> originX_save, originY_save;
+
+	Engine engine;
+	qreal clock;				// path length travelled by every electron
+	QVector<qreal> flightTime;	// clock value at which electron i is positioned
+	bool eventsDirty;
+
+	int threads;
+	QVector<Partition> partitions;
+	Columns columns;
+
+	quint32 seed;
+
+	qreal clock_save;
+	QVector<qreal> flightTime_save;
+
+	bool paintTraceOnly;
+
+	int nbins, bin;
+	qreal binwidth;
+
+	qreal timeFull, timeInside, impulseSum;
+	QVector<qreal> timeInsideAll;
+	QVector<qreal> time;		// values of time
+	QVector<qreal> prob;		// magnitude of the bin
+	QVector<qreal> density;		// density of the electrons
+	QVector<QVector<qreal> > densities;	// density at each point
+	QVector<qreal> impulses;	// overall sum of collision impulses
+
+	HistoryPolicy historyPolicy;
+	int historyCapacity;
+	int historyRevision;		// changes when points are removed
+
+	MeasurementSink *sink;
+};
+
+#endif
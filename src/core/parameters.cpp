@@ -0,0 +1,47 @@
+#include "parameters.h"
+
+Parameters::Parameters()
+{
+	width = 400;
+	height = 400;
+	side = 25;
+	geometry = Model::SquareGeometry;
+	boundary = Model::ReflectingBoundary;
+	atomR = 5;
+	electronR = 2;
+	speed = 100;
+	num = 100;
+	nbins = 3;
+	bin = 1;
+	threads = 0;
+	seed = 1;
+	engine = Model::TimeStepEngine;
+	history = Model::DownsampledHistory;
+	historySize = Model::MAX_HISTORY;
+}
+
+void Parameters::apply(Model& model) const
+{
+	// setDim before setSide: the offset of the lattice comes from the side
+	// the model starts with, as in the GUI whose widget sets the dimensions
+	// before the settings
+	model.setDim(width, height);
+	model.setSide(side);
+	model.setAtomR(atomR);
+	model.setElectronR(electronR);
+	model.setSpeed(speed);
+	model.setBinsNumber(nbins);
+	model.setBinIndex(bin - 1);
+	model.setThreads(threads);
+	model.setEngine(engine);
+	model.setSeed(seed);
+	model.setBoundary(boundary);
+	// last, the disordered atoms are drawn once everything is set
+	model.setScatterers(scatterers);
+	model.setGeometry(geometry);
+	model.setHistory(history, historySize);
+
+	model.setNumber(0);
+	model.setNumber(num);
+	model.clear();
+}
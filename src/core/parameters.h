@@ -0,0 +1,37 @@
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+#include "model.h"
+
+/*
+ * Complete set of model parameters for runs without the GUI.
+ */
+struct Parameters
+{
+	Parameters();
+
+	// Configures the model through its setters, then places num electrons
+	// at random from the seed, clear of the final atoms. The lattice is
+	// laid out as in the GUI; the electrons are not placed as there, the
+	// GUI places them first and moves those a later change traps.
+	void apply(Model& model) const;
+
+	int width, height;
+	int side;
+	Model::Geometry geometry;
+	QVector<QPointF> scatterers;	// atoms of DisorderedGeometry, empty for random
+	Model::Boundary boundary;
+	qreal atomR;
+	qreal electronR;
+	qreal speed;
+	int num;
+	int nbins;
+	int bin;		// bin to estimate the probability, from 1 as in the GUI
+	int threads;
+	int seed;
+	Model::Engine engine;
+	Model::HistoryPolicy history;
+	int historySize;
+};
+
+#endif
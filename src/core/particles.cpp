@@ -0,0 +1,92 @@
+#include "particles.h"
+
+#include <string.h>
+
+static qreal *allocColumn(int capacity)
+{
+	return (qreal *)qMallocAligned(capacity * sizeof(qreal), Particles::alignment);
+}
+
+Particles::Particles()
+	: x(0), y(0), vx(0), vy(0), n(0), capacity(0)
+{
+}
+
+Particles::Particles(const Particles& other)
+	: x(0), y(0), vx(0), vy(0), n(0), capacity(0)
+{
+	*this = other;
+}
+
+Particles& Particles::operator=(const Particles& other)
+{
+	if (this == &other)
+		return *this;
+	if (capacity < other.n)
+		reserve(other.n);
+	n = other.n;
+	memcpy(x, other.x, n * sizeof(qreal));
+	memcpy(y, other.y, n * sizeof(qreal));
+	memcpy(vx, other.vx, n * sizeof(qreal));
+	memcpy(vy, other.vy, n * sizeof(qreal));
+	return *this;
+}
+
+Particles::~Particles()
+{
+	release();
+}
+
+void Particles::append(qreal px, qreal py, qreal pvx, qreal pvy)
+{
+	if (n == capacity)
+		reserve(capacity ? 2*capacity : 64);
+	x[n] = px;
+	y[n] = py;
+	vx[n] = pvx;
+	vy[n] = pvy;
+	n++;
+}
+
+void Particles::pop()
+{
+	if (n > 0)
+		n--;
+}
+
+void Particles::clear()
+{
+	n = 0;
+}
+
+void Particles::reserve(int newCapacity)
+{
+	qreal *nx = allocColumn(newCapacity);
+	qreal *ny = allocColumn(newCapacity);
+	qreal *nvx = allocColumn(newCapacity);
+	qreal *nvy = allocColumn(newCapacity);
+	if (n) {
+		memcpy(nx, x, n * sizeof(qreal));
+		memcpy(ny, y, n * sizeof(qreal));
+		memcpy(nvx, vx, n * sizeof(qreal));
+		memcpy(nvy, vy, n * sizeof(qreal));
+	}
+	int keep = n;
+	release();
+	x = nx;
+	y = ny;
+	vx = nvx;
+	vy = nvy;
+	n = keep;
+	capacity = newCapacity;
+}
+
+void Particles::release()
+{
+	qFreeAligned(x);
+	qFreeAligned(y);
+	qFreeAligned(vx);
+	qFreeAligned(vy);
+	x = y = vx = vy = 0;
+	n = capacity = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <QtGlobal>
+
+/*
+ * Electron state stored column-wise (structure of arrays).
+ * x, y are the positions, vx, vy the unit velocity vectors; the magnitude
+ * of the velocity is the speed shared by the whole model.
+ * The columns are aligned for the SIMD free-flight kernel.
+ */
+class Particles
+{
+public:
+	static const int alignment = 32;
+
+	Particles();
+	Particles(const Particles& other);
+	Particles& operator=(const Particles& other);
+	~Particles();
+
+	int size() const { return n; }
+	void append(qreal px, qreal py, qreal pvx, qreal pvy);
+	void pop();
+	void clear();
+
+	qreal *x;
+	qreal *y;
+	qreal *vx;
+	qreal *vy;
+
+private:
+	void reserve(int newCapacity);
+	void release();
+
+	int n;
+	int capacity;
+};
+
+#endif
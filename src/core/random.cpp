@@ -0,0 +1,49 @@
+#include "random.h"
+
+static const quint32 M0 = 0xD2511F53;
+static const quint32 M1 = 0xCD9E8D57;
+static const quint32 W0 = 0x9E3779B9;
+static const quint32 W1 = 0xBB67AE85;
+
+Random::Random(quint64 seed, quint64 stream)
+{
+	key[0] = (quint32)seed;
+	key[1] = (quint32)(seed >> 32);
+	// the low half of the counter numbers the blocks, the high half the stream
+	counter[0] = 0;
+	counter[1] = 0;
+	counter[2] = (quint32)stream;
+	counter[3] = (quint32)(stream >> 32);
+	used = 4;
+}
+
+void Random::philox(const quint32 counter[4], const quint32 key[2], quint32 out[4])
+{
+	quint32 c[4] = { counter[0], counter[1], counter[2], counter[3] };
+	quint32 k[2] = { key[0], key[1] };
+
+	for (int round = 0; round < 10; round++) {
+		quint64 p0 = (quint64)M0 * c[0];
+		quint64 p1 = (quint64)M1 * c[2];
+		quint32 hi0 = (quint32)(p0 >> 32), lo0 = (quint32)p0;
+		quint32 hi1 = (quint32)(p1 >> 32), lo1 = (quint32)p1;
+		c[0] = hi1 ^ c[1] ^ k[0];
+		c[1] = lo1;
+		c[2] = hi0 ^ c[3] ^ k[1];
+		c[3] = lo0;
+		k[0] += W0;
+		k[1] += W1;
+	}
+
+	for (int i = 0; i < 4; i++)
+		out[i] = c[i];
+}
+
+void Random::generate()
+{
+	philox(counter, key, block);
+	used = 0;
+
+	if (++counter[0] == 0)
+		counter[1]++;
+}
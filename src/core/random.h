@@ -0,0 +1,44 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <QtGlobal>
+
+/*
+ * Counter-based random generator (Philox4x32-10, Salmon et al. 2011).
+ * Every (seed, stream) pair gives an independent sequence, so each
+ * electron can draw from its own stream and the results do not depend
+ * on the order or the thread in which electrons are generated.
+ */
+class Random
+{
+public:
+	Random(quint64 seed, quint64 stream);
+
+	quint32 next()
+	{
+		if (used == 4)
+			generate();
+		return block[used++];
+	}
+
+	// Uniform in [0, 1) with 53 random bits
+	qreal uniform()
+	{
+		quint32 a = next() >> 5;
+		quint32 b = next() >> 6;
+		return (a * 67108864.0 + b) / 9007199254740992.0;
+	}
+
+	// The Philox4x32-10 bijection of a counter block under a key
+	static void philox(const quint32 counter[4], const quint32 key[2], quint32 out[4]);
+
+private:
+	void generate();
+
+	quint32 key[2];
+	quint32 counter[4];
+	quint32 block[4];
+	int used;
+};
+
+#endif
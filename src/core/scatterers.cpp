@@ -0,0 +1,158 @@
+#include "scatterers.h"
+#include "random.h"
+
+// The electrons draw from streams 0, 1, ...; the atoms from one beyond them
+static const quint64 scatterStream = Q_UINT64_C(1) << 32;
+
+ScattererGrid::ScattererGrid()
+	: width(1), height(1), periodic(false), spill(false), cw(1), ch(1), nx(1), ny(1), start(2, 0),
+	  gap(std::numeric_limits<qreal>::infinity())
+{
+}
+
+ScattererGrid::ScattererGrid(const QVector<QPointF>& centres, qreal w, qreal h, qreal cell, bool wrap)
+{
+	width = w > 0 ? w : 1;
+	height = h > 0 ? h : 1;
+	periodic = wrap;
+	cell = cell > 0 ? cell : 1;
+	// whole cells over the area, so that they tile it when periodic
+	nx = qMax(1, qCeil(width / cell));
+	ny = qMax(1, qCeil(height / cell));
+	cw = width / nx;
+	ch = height / ny;
+
+	// counting sort of the centres by cell
+	int n = centres.size();
+	QVector<qreal> cx(n), cy(n);
+	QVector<int> cellOf(n);
+	start = QVector<int>(nx*ny + 1, 0);
+	spill = false;
+	for (int a = 0; a < n; a++) {
+		cx[a] = centres[a].x();
+		cy[a] = centres[a].y();
+		if (periodic) {
+			cx[a] -= qFloor(cx[a] / width) * width;
+			cy[a] -= qFloor(cy[a] / height) * height;
+		}
+		else if (cx[a] < 0 || cx[a] >= width || cy[a] < 0 || cy[a] >= height)
+			spill = true;
+		cellOf[a] = qMin(cellY(cy[a]), ny - 1)*nx + qMin(cellX(cx[a]), nx - 1);
+		start[cellOf[a] + 1]++;
+	}
+	for (int k = 0; k < nx*ny; k++)
+		start[k+1] += start[k];
+	QVector<int> fill = start;
+	xs.resize(n);
+	ys.resize(n);
+	for (int a = 0; a < n; a++) {
+		int to = fill[cellOf[a]]++;
+		xs[to] = cx[a];
+		ys[to] = cy[a];
+	}
+
+	// atoms in cells more than one apart are at least a cell apart
+	gap = qMin(cw, ch);
+	for (int j = 0; j < ny; j++) {
+		for (int i = 0; i < nx; i++) {
+			for (int a = start[j*nx + i]; a < start[j*nx + i + 1]; a++) {
+				for (int jj = j - 1; jj <= j + 1; jj++) {
+					for (int ii = i - 1; ii <= i + 1; ii++) {
+						int c;
+						qreal sx, sy;
+						if (!locate(ii, jj, c, sx, sy))
+							continue;
+						for (int b = start[c]; b < start[c+1]; b++) {
+							if (b == a && sx == 0 && sy == 0)
+								continue;
+							qreal dx = xs[a] - xs[b] - sx;
+							qreal dy = ys[a] - ys[b] - sy;
+							gap = qMin(gap, qSqrt(dx*dx + dy*dy));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Random sequential addition over a background grid of cells of at most
+ * distance/sqrt(2), each holding at most one centre, so that a candidate
+ * is only compared with the centres of the few cells around it.
+ */
+QVector<QPointF> ScattererGrid::scatter(int count, qreal distance, qreal width, qreal height,
+										bool periodic, quint32 seed)
+{
+	QVector<QPointF> centres;
+	if (count <= 0 || width <= 0 || height <= 0)
+		return centres;
+	centres.reserve(count);
+	Random random(seed, scatterStream);
+
+	if (distance <= 0) {
+		for (int a = 0; a < count; a++) {
+			qreal x = random.uniform() * width;
+			centres.append(QPointF(x, random.uniform() * height));
+		}
+		return centres;
+	}
+
+	int gx = qMax(1, qCeil(width * qSqrt(2) / distance));
+	int gy = qMax(1, qCeil(height * qSqrt(2) / distance));
+	qreal hx = width / gx;
+	qreal hy = height / gy;
+	int reachX = qCeil(distance / hx);
+	int reachY = qCeil(distance / hy);
+	QVector<int> owner(gx*gy, -1);
+
+	for (int trial = 0; trial < 30*count && centres.size() < count; trial++) {
+		qreal x = random.uniform() * width;
+		qreal y = random.uniform() * height;
+		int cx = qMin(gx - 1, (int)(x / hx));
+		int cy = qMin(gy - 1, (int)(y / hy));
+
+		bool fits = owner[cy*gx + cx] < 0;
+		for (int j = cy - reachY; fits && j <= cy + reachY; j++) {
+			for (int i = cx - reachX; fits && i <= cx + reachX; i++) {
+				// the cells across the edges hold the images of the far side
+				int wi = (i % gx + gx) % gx;
+				int wj = (j % gy + gy) % gy;
+				if (!periodic && (wi != i || wj != j))
+					continue;
+				int a = owner[wj*gx + wi];
+				if (a < 0)
+					continue;
+				qreal dx = x - centres[a].x() - (i - wi) / gx * width;
+				qreal dy = y - centres[a].y() - (j - wj) / gy * height;
+				if (dx*dx + dy*dy < distance*distance)
+					fits = false;
+			}
+		}
+		if (fits) {
+			owner[cy*gx + cx] = centres.size();
+			centres.append(QPointF(x, y));
+		}
+	}
+	return centres;
+}
+
+QVector<QPointF> ScattererGrid::centres(const QRectF& area) const
+{
+	QVector<QPointF> list;
+	for (int j = cellY(area.top()); j <= cellY(area.bottom()); j++) {
+		for (int i = cellX(area.left()); i <= cellX(area.right()); i++) {
+			int c;
+			qreal sx, sy;
+			if (!locate(i, j, c, sx, sy))
+				continue;
+			for (int a = start[c]; a < start[c+1]; a++) {
+				qreal x = xs[a] + sx;
+				qreal y = ys[a] + sy;
+				if (x >= area.left() && x <= area.right() && y >= area.top() && y <= area.bottom())
+					list.append(QPointF(x, y));
+			}
+		}
+	}
+	return list;
+}
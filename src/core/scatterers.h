@@ -0,0 +1,220 @@
+#ifndef SCATTERERS_H
+#define SCATTERERS_H
+
+#include <QtGlobal>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <qmath.h>
+
+#include <limits>
+
+/*
+ * Atoms at arbitrary positions, the disordered Lorentz gas. The centres
+ * are bucketed in a uniform grid of cells, so that the queries only
+ * visit the cells around a point or along a ray and cost the same
+ * whatever the number of atoms. Offers the queries of the lattice
+ * policies of lattice.h.
+ *
+ * A periodic grid repeats its atoms with the period of its area, for
+ * the periodic boundaries; the queries then see the images across the
+ * edges.
+ */
+class ScattererGrid
+{
+public:
+	ScattererGrid();
+
+	// Buckets the centres over [0, width] x [0, height] in cells of about
+	// the given size. Centres outside go to the border cells, or are
+	// wrapped into the area if periodic.
+	ScattererGrid(const QVector<QPointF>& centres, qreal width, qreal height, qreal cell, bool periodic);
+
+	// Up to count centres drawn uniformly in [0, width] x [0, height] from
+	// the seed, at least distance apart, across the edges if periodic.
+	// Fewer when they do not fit.
+	static QVector<QPointF> scatter(int count, qreal distance, qreal width, qreal height,
+									bool periodic, quint32 seed);
+
+	int size() const { return xs.size(); }
+
+	qreal periodX() const { return width; }
+	qreal periodY() const { return height; }
+
+	// nearest and firstHit add the number of atoms they test to tested, if
+	// given, the measure of their cost
+	qreal nearest(qreal x, qreal y, qreal& xC, qreal& yC, int *tested = 0) const
+	{
+		qreal best = std::numeric_limits<qreal>::infinity();
+		xC = yC = 0;
+		int cx = cellX(x);
+		int cy = cellY(y);
+		qreal cell = qMin(cw, ch);
+		int rings = qMax(nx, ny) + 1;
+		for (int k = 0; k < rings; k++) {
+			for (int j = cy - k; j <= cy + k; j++) {
+				// the whole row on the top and bottom of the ring, its ends otherwise
+				int step = k == 0 || j == cy - k || j == cy + k ? 1 : 2*k;
+				for (int i = cx - k; i <= cx + k; i += step) {
+					int c;
+					qreal sx, sy;
+					if (!locate(i, j, c, sx, sy))
+						continue;
+					if (tested)
+						*tested += start[c+1] - start[c];
+					for (int a = start[c]; a < start[c+1]; a++) {
+						qreal ax = xs[a] + sx;
+						qreal ay = ys[a] + sy;
+						qreal dist = (x-ax)*(x-ax) + (y-ay)*(y-ay);
+						if (dist < best) {
+							best = dist;
+							xC = ax;
+							yC = ay;
+						}
+					}
+				}
+			}
+			// the cells beyond ring k are at least k cells away
+			if (best <= (k*cell)*(k*cell))
+				break;
+		}
+		return best;
+	}
+
+	bool overlaps(qreal x, qreal y, qreal r) const
+	{
+		int reachX = qCeil(r / cw);
+		int reachY = qCeil(r / ch);
+		int cx = cellX(x);
+		int cy = cellY(y);
+		for (int j = cy - reachY; j <= cy + reachY; j++) {
+			for (int i = cx - reachX; i <= cx + reachX; i++) {
+				int c;
+				qreal sx, sy;
+				if (!locate(i, j, c, sx, sy))
+					continue;
+				for (int a = start[c]; a < start[c+1]; a++) {
+					qreal ax = xs[a] + sx;
+					qreal ay = ys[a] + sy;
+					if ((x-ax)*(x-ax) + (y-ay)*(y-ay) <= r*r)
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	qreal inradius() const { return gap / 2; }
+
+	// Walks the cells pierced by the ray and tests the atoms of the cells
+	// within reach of R, skipping the atoms the ray is leaving or inside of
+	bool firstHit(const QPointF& p, const QPointF& d, qreal R, qreal tMax, qreal& t, QPointF& centre,
+				  int *tested = 0) const
+	{
+		const qreal inf = std::numeric_limits<qreal>::infinity();
+		int reachX = qCeil(R / cw);
+		int reachY = qCeil(R / ch);
+
+		int cx = qFloor(p.x() / cw);
+		int cy = qFloor(p.y() / ch);
+		int stepX = d.x() > 0 ? 1 : -1;
+		int stepY = d.y() > 0 ? 1 : -1;
+		qreal tNextX = d.x() != 0 ? ((cx + (stepX > 0))*cw - p.x()) / d.x() : inf;
+		qreal tNextY = d.y() != 0 ? ((cy + (stepY > 0))*ch - p.y()) / d.y() : inf;
+		qreal tDeltaX = d.x() != 0 ? cw / qAbs(d.x()) : inf;
+		qreal tDeltaY = d.y() != 0 ? ch / qAbs(d.y()) : inf;
+
+		bool found = false;
+		t = tMax;
+		for (;;) {
+			for (int j = cy - reachY; j <= cy + reachY; j++) {
+				for (int i = cx - reachX; i <= cx + reachX; i++) {
+					int c;
+					qreal sx, sy;
+					if (!locate(i, j, c, sx, sy))
+						continue;
+					if (tested)
+						*tested += start[c+1] - start[c];
+					for (int a = start[c]; a < start[c+1]; a++) {
+						qreal rx = p.x() - (xs[a] + sx);
+						qreal ry = p.y() - (ys[a] + sy);
+						qreal b = rx*d.x() + ry*d.y();
+						qreal q = rx*rx + ry*ry - R*R;
+						if (b >= 0 || q <= 0)
+							continue;
+						qreal D = b*b - q;
+						if (D < 0)
+							continue;
+						qreal th = -b - qSqrt(D);
+						if (th < t) {
+							t = th;
+							centre = QPointF(xs[a] + sx, ys[a] + sy);
+							found = true;
+						}
+					}
+				}
+			}
+			// nothing outside the visited cells can be hit before leaving this one
+			if (t <= qMin(tNextX, tNextY))
+				return found;
+			if (tNextX < tNextY) {
+				cx += stepX;
+				tNextX += tDeltaX;
+			}
+			else {
+				cy += stepY;
+				tNextY += tDeltaY;
+			}
+		}
+	}
+
+	QVector<QPointF> centres(const QRectF& area) const;
+
+private:
+	// Cell of a point, the border one for points outside a bounded grid
+	int cellX(qreal x) const
+	{
+		int i = qFloor(x / cw);
+		return periodic ? i : qBound(0, i, nx - 1);
+	}
+	int cellY(qreal y) const
+	{
+		int j = qFloor(y / ch);
+		return periodic ? j : qBound(0, j, ny - 1);
+	}
+
+	// Bucket c of the atoms seen in cell (i, j) and the shift of their
+	// images; false if there is no such cell. The cells beyond the edges
+	// of a bounded grid are its border ones when centres lie outside.
+	bool locate(int i, int j, int& c, qreal& sx, qreal& sy) const
+	{
+		if (periodic) {
+			int wi = (i % nx + nx) % nx;
+			int wj = (j % ny + ny) % ny;
+			c = wj*nx + wi;
+			sx = (i - wi) / nx * width;
+			sy = (j - wj) / ny * height;
+			return true;
+		}
+		if (i < 0 || i >= nx || j < 0 || j >= ny) {
+			if (!spill)
+				return false;
+			i = qBound(0, i, nx - 1);
+			j = qBound(0, j, ny - 1);
+		}
+		c = j*nx + i;
+		sx = sy = 0;
+		return true;
+	}
+
+	qreal width, height;
+	bool periodic;
+	bool spill;				// centres outside the area, in the border cells
+	qreal cw, ch;			// cell size
+	int nx, ny;
+	QVector<int> start;		// atoms of cell c = j*nx + i are start[c] .. start[c+1]-1
+	QVector<qreal> xs, ys;	// centres sorted by cell
+	qreal gap;				// lower bound of the distance between two centres
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "streamwriter.h"
+
+#include <QTextStream>
+#include <QDataStream>
+
+StreamWriter::StreamWriter(const QString& fileName, Format format, int blockSize)
+	: file(fileName), format(format), blockSize(qMax(1, blockSize))
+{
+	current.count = 0;
+	current.nbins = 0;
+	busy = false;
+	stopping = false;
+	failed = false;
+	headerWritten = false;
+
+	QIODevice::OpenMode mode = QIODevice::WriteOnly;
+	if (format == Csv)
+		mode |= QIODevice::Text;
+	if (file.open(mode))
+		start();
+}
+
+StreamWriter::~StreamWriter()
+{
+	close();
+}
+
+void StreamWriter::measure(qreal time, qreal prob, qreal impulses, const QVector<qreal>& density)
+{
+	if (!isOpen())
+		return;
+	if (current.count > 0 && density.size() != current.nbins)
+		submit();
+
+	if (current.count == 0) {
+		current.nbins = density.size();
+		current.time.reserve(blockSize);
+		current.prob.reserve(blockSize);
+		current.impulses.reserve(blockSize);
+		current.density.reserve(blockSize*current.nbins);
+	}
+	current.time.append(time);
+	current.prob.append(prob);
+	current.impulses.append(impulses);
+	current.density += density;
+	current.count++;
+
+	if (current.count >= blockSize)
+		submit();
+}
+
+void StreamWriter::submit()
+{
+	if (current.count == 0)
+		return;
+
+	mutex.lock();
+	queue.append(current);
+	wake.wakeOne();
+	mutex.unlock();
+
+	current = Block();
+	current.count = 0;
+	current.nbins = 0;
+}
+
+void StreamWriter::flush()
+{
+	if (!isOpen())
+		return;
+	submit();
+
+	mutex.lock();
+	while (!queue.isEmpty() || busy)
+		idle.wait(&mutex);
+	mutex.unlock();
+}
+
+bool StreamWriter::close()
+{
+	if (!isOpen())
+		return false;
+	submit();
+
+	mutex.lock();
+	stopping = true;
+	wake.wakeOne();
+	mutex.unlock();
+
+	wait();
+	file.close();
+	return !failed;
+}
+
+void StreamWriter::run()
+{
+	bool ok = true;
+	if (format == Binary) {
+		ok = file.write("LRNZ", 4) == 4;
+		QDataStream out(&file);
+		out.setByteOrder(QDataStream::LittleEndian);
+		out << (quint32)1;
+		ok = ok && out.status() == QDataStream::Ok;
+	}
+
+	mutex.lock();
+	failed = !ok;
+	forever {
+		while (queue.isEmpty() && !stopping)
+			wake.wait(&mutex);
+		if (queue.isEmpty())
+			break;
+		Block block = queue.takeFirst();
+		busy = true;
+		mutex.unlock();
+
+		ok = format == Csv ? writeCsv(block) : writeBinary(block);
+		ok = file.flush() && ok;
+
+		mutex.lock();
+		busy = false;
+		failed = failed || !ok;
+		if (queue.isEmpty())
+			idle.wakeAll();
+	}
+	mutex.unlock();
+}
+
+bool StreamWriter::writeCsv(const Block& block)
+{
+	QTextStream out(&file);
+	out.setRealNumberPrecision(12);
+
+	if (!headerWritten) {
+		out << "time,prob,impulses";
+		for (int b = 0; b < block.nbins; b++)
+			out << ",density_" << b+1;
+		out << "\n";
+		headerWritten = true;
+	}
+
+	const qreal *density = block.density.constData();
+	for (int i = 0; i < block.count; i++) {
+		out << block.time[i] << "," << block.prob[i] << "," << block.impulses[i];
+		for (int b = 0; b < block.nbins; b++)
+			out << "," << *density++;
+		out << "\n";
+	}
+	out.flush();
+	return out.status() == QTextStream::Ok;
+}
+
+bool StreamWriter::writeBinary(const Block& block)
+{
+	QDataStream out(&file);
+	out.setByteOrder(QDataStream::LittleEndian);
+	out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+	out << (quint32)block.count << (quint32)block.nbins;
+	for (int i = 0; i < block.count; i++)
+		out << (double)block.time[i];
+	for (int i = 0; i < block.count; i++)
+		out << (double)block.prob[i];
+	for (int i = 0; i < block.count; i++)
+		out << (double)block.impulses[i];
+	for (int b = 0; b < block.nbins; b++) {
+		for (int i = 0; i < block.count; i++)
+			out << (double)block.density[i*block.nbins + b];
+	}
+	return out.status() == QDataStream::Ok;
+}
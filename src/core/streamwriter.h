@@ -0,0 +1,73 @@
+#ifndef STREAMWRITER_H
+#define STREAMWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QList>
+
+#include "measurementsink.h"
+
+/*
+ * Streams the measurements to a file. They are gathered in blocks of
+ * blockSize measurements, which a thread of the writer formats and
+ * writes, so that Model::step only copies a few numbers.
+ *
+ * Csv: a header "time,prob,impulses,density_1,..." then a line per
+ * measurement.
+ * Binary: the magic "LRNZ" and a quint32 version, then the blocks, each
+ * a quint32 count n, a quint32 number of bins m and the columns time[n],
+ * prob[n], impulses[n], then density[n] of each of the m bins in turn,
+ * all little endian doubles. A block always has a single number of bins.
+ */
+class StreamWriter : public QThread, public MeasurementSink
+{
+public:
+	enum Format { Csv, Binary };
+
+	StreamWriter(const QString& fileName, Format format, int blockSize = 4096);
+	~StreamWriter();
+
+	// False if the file could not be created
+	bool isOpen() const { return file.isOpen(); }
+
+	void measure(qreal time, qreal prob, qreal impulses, const QVector<qreal>& density);
+
+	// Writes out the pending measurements and waits for the file
+	void flush();
+
+	// Flushes and closes the file; false if anything failed to be written
+	bool close();
+
+private:
+	// Measurements stored column by column, density row by row
+	struct Block {
+		int count;
+		int nbins;
+		QVector<qreal> time, prob, impulses, density;
+	};
+
+	void run();
+	void submit();
+	bool writeCsv(const Block& block);
+	bool writeBinary(const Block& block);
+
+	QFile file;
+	Format format;
+	int blockSize;
+
+	Block current;			// filled by measure()
+
+	QMutex mutex;			// guards the members below
+	QWaitCondition wake;	// a block is queued or the writer must stop
+	QWaitCondition idle;	// the queue has been written
+	QList<Block> queue;
+	bool busy;				// the thread is writing a block
+	bool stopping;
+	bool failed;
+
+	bool headerWritten;		// touched by the writer thread only
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+#include "sweep.h"
+#include "model.h"
+
+namespace {
+
+struct Run {
+	Model *model;
+	Sweep::Result *result;
+	qreal cost;
+
+	// longest runs first, so that short ones fill the gaps at the end
+	bool operator<(const Run& other) const { return cost > other.cost; }
+};
+
+struct RunTask {
+	typedef void result_type;
+
+	int duration;
+	int step;
+
+	void operator()(Run& run) const
+	{
+		Model *model = run.model;
+		for (int elapsed = 0; elapsed < duration; elapsed += step)
+			model->step(step);
+
+		Sweep::Result *result = run.result;
+		QVector<qreal> time = model->getTime();
+		if (!time.isEmpty()) {
+			result->prob = model->getProb().last();
+			result->pressure = model->getImpulses().last() / time.last();
+		}
+		result->density = model->getDensity();
+
+		delete model;
+		run.model = 0;
+	}
+};
+
+// Work estimate: a sweep over the electrons per step plus the collisions
+qreal estimateCost(const Parameters& p, int duration, int step)
+{
+	qreal steps = (qreal)duration / step;
+	qreal path = p.speed * duration / 1000;
+	return p.num * (steps + path / p.side);
+}
+
+}
+
+Sweep::Sweep(const Parameters& base)
+	: base(base)
+{
+	sides.append(base.side);
+	atomRs.append(base.atomR);
+	electronRs.append(base.electronR);
+	speeds.append(base.speed);
+}
+
+void Sweep::run(int duration, int step)
+{
+	results.clear();
+	for (int a = 0; a < sides.size(); a++)
+		for (int b = 0; b < atomRs.size(); b++)
+			for (int c = 0; c < electronRs.size(); c++)
+				for (int d = 0; d < speeds.size(); d++) {
+					Result result;
+					result.params = base;
+					result.params.side = sides[a];
+					result.params.atomR = atomRs[b];
+					result.params.electronR = electronRs[c];
+					result.params.speed = speeds[d];
+					// the runs fill the cores, not the electrons of one run
+					result.params.threads = 1;
+					result.prob = 0;
+					result.pressure = 0;
+					result.atoms = 0;
+					result.atomsTarget = 0;
+					results.append(result);
+				}
+
+	QVector<Run> runs;
+	for (int i = 0; i < results.size(); i++) {
+		Run run;
+		run.model = new Model;
+		results[i].params.apply(*run.model);
+		results[i].atoms = run.model->getScattererCount();
+		results[i].atomsTarget = run.model->getScattererTarget();
+		run.result = &results[i];
+		run.cost = estimateCost(results[i].params, duration, step);
+		runs.append(run);
+	}
+	std::sort(runs.begin(), runs.end());
+
+	RunTask task;
+	task.duration = duration;
+	task.step = step;
+	QtConcurrent::blockingMap(runs, task);
+}
@@ -0,0 +1,48 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QVector>
+
+#include "parameters.h"
+
+/*
+ * Runs the model over the grid of side, atom radius, electron radius and
+ * speed values, with the other parameters taken from a base set.
+ * Runs are spread over the thread pool, the longest ones first.
+ */
+class Sweep
+{
+public:
+	struct Result {
+		Parameters params;
+		qreal prob;
+		qreal pressure;
+		QVector<qreal> density;
+		int atoms;			// disordered atoms placed, 0 for the lattices
+		int atomsTarget;	// and asked for
+	};
+
+	Sweep(const Parameters& base);
+
+	void setSides(const QVector<int>& values) { sides = values; }
+	void setAtomRs(const QVector<qreal>& values) { atomRs = values; }
+	void setElectronRs(const QVector<qreal>& values) { electronRs = values; }
+	void setSpeeds(const QVector<qreal>& values) { speeds = values; }
+
+	// Runs every grid point for duration milliseconds in steps of step ms
+	void run(int duration, int step);
+
+	// Final measurements, in grid order (speed varies fastest)
+	QVector<Result> getResults() const { return results; }
+
+private:
+	Parameters base;
+	QVector<int> sides;
+	QVector<qreal> atomRs;
+	QVector<qreal> electronRs;
+	QVector<qreal> speeds;
+
+	QVector<Result> results;
+};
+
+#endif
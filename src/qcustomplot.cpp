@@ -42,10 +42,11 @@
   
   The range an axis shows is handled by the simple QCustomPlotRange class. Plottable data is
   assigned to a graph via its QCustomPlotGraph::setData functions. The data is stored internally as
-  a ::QCustomPlotDataMap which is a QMap mapping a key of type double to the actual data storage
-  container QCustomPlotData. Assigning data by creating own QCustomPlotData instances, filling them
-  with data points, and passing them to %QCustomPlotGraph is possible but not necessary. More user
-  friendly functions exist that accept for example QVector<double> parameters as x, y, errors, etc.
+  a QCustomPlotDataArray which keeps the keys and values sorted in contiguous arrays. Assigning
+  data by creating own QCustomPlotData instances, filling them with data points, and passing them
+  to %QCustomPlotGraph (one by one or in a ::QCustomPlotDataMap) is possible but not necessary.
+  More user friendly functions exist that accept for example QVector<double> parameters as x, y,
+  errors, etc.
   
   Every %QCustomPlot owns a QCustomPlotLegend (as \a legend). That's a small window inside the plot
   which lists the graphs with an icon of the graph line/symbol and a description. The Description
@@ -66,8 +67,8 @@
   (QCustomPlot::setAntialiasedElements)
   \li avoid repeatedly setting the complete data set with setData. Use addData instead, if most
   data points stay unchanged, e.g. in a running measurement.
-  \li set the \a copy parameter of the setData functions to false, so only pointers get
-  transferred.
+  \li add data points in ascending key order, they are then appended to the sorted arrays
+  without a search.
   \li on X11 (linux), avoid the (slow) native drawing system, use raster by supplying
   "-graphicssystem raster" as command line argument
   \li on all operating systems, use OpenGL hardware acceleration by supplying "-graphicssystem
@@ -82,28 +83,6 @@
 
 #include "qcustomplot.h"
 
-// ================================================================================
-// =================== QCustomPlotData
-// ================================================================================
-
-/*! \class QCustomPlotData
-  A class holding the data of one single data point.
-  \see QCustomPlotDataMap
-*/
-
-/*!
-  Constructs an empty data point with key, value and all errors set to zero.
-*/
-QCustomPlotData::QCustomPlotData() :
-  key(0),
-  value(0),
-  keyErrorPlus(0),
-  keyErrorMinus(0),
-  valueErrorPlus(0),
-  valueErrorMinus(0)
-{
-}
-
 // ================================================================================
 // =================== QCustomPlotGraph
 // ================================================================================
@@ -129,7 +108,7 @@ QCustomPlotGraph::QCustomPlotGraph(QCustomPlotAxis *keyaxis, QCustomPlotAxis *va
   mKeyAxis = keyaxis;
   mValueAxis = valueaxis;
   mParentPlot = keyaxis->mParentPlot;
-  mData = new QCustomPlotDataMap;
+  mData = new QCustomPlotDataArray;
   mVisible = true;
   mPen.setColor(Qt::blue);
   mPen.setStyle(Qt::SolidLine);
@@ -219,19 +198,14 @@ void QCustomPlotGraph::setValueAxis(QCustomPlotAxis *valueaxis)
   
   \param data a number of data points organized in a QCustomPlotDataMap which will replace the currently set data
   \param copy if true, data points in \a data will only be copied. if false, the graph takes ownership of the
-  passed QCustomPlotDataMap and replaces the internal data pointer with it. This is significantly faster than copying for
-  large datasets.
+  passed QCustomPlotDataMap and deletes it after copying the points into its own storage.
 */
 void QCustomPlotGraph::setData(QCustomPlotDataMap *data, bool copy)
 {
-  if (copy)
-  {
-    *mData = *data;
-  } else
-  {
-    delete mData;
-    mData = data;
-  }
+  mData->clear();
+  mData->insert(*data);
+  if (!copy)
+    delete data;
 }
 
 /*!
@@ -243,14 +217,15 @@ void QCustomPlotGraph::setData(const QVector<double> &key, const QVector<double>
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -264,17 +239,18 @@ void QCustomPlotGraph::setDataValueError(const QVector<double> &key, const QVect
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -289,18 +265,19 @@ void QCustomPlotGraph::setDataValueError(const QVector<double> &key, const QVect
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -314,17 +291,18 @@ void QCustomPlotGraph::setDataKeyError(const QVector<double> &key, const QVector
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, keyError.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -339,18 +317,19 @@ void QCustomPlotGraph::setDataKeyError(const QVector<double> &key, const QVector
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -364,20 +343,21 @@ void QCustomPlotGraph::setDataBothError(const QVector<double> &key, const QVecto
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
   n = qMin(n, keyError.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -392,22 +372,23 @@ void QCustomPlotGraph::setDataBothError(const QVector<double> &key, const QVecto
 {
   mData->clear();
   int n = key.size();
+  mData->reserve(n);
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -416,7 +397,7 @@ void QCustomPlotGraph::setDataBothError(const QVector<double> &key, const QVecto
 */
 void QCustomPlotGraph::addData(const QCustomPlotDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  mData->insert(dataMap);
 }
 
 /*!
@@ -425,7 +406,7 @@ void QCustomPlotGraph::addData(const QCustomPlotDataMap &dataMap)
 */
 void QCustomPlotGraph::addData(const QCustomPlotData &data)
 {
-  mData->insertMulti(data.key, data);
+  mData->insert(data);
 }
 
 /*!
@@ -434,10 +415,7 @@ void QCustomPlotGraph::addData(const QCustomPlotData &data)
 */
 void QCustomPlotGraph::addData(double key, double value)
 {
-  QCustomPlotData newData;
-  newData.key = key;
-  newData.value = value;
-  mData->insertMulti(newData.key, newData);
+  mData->insert(key, value);
 }
 
 /*!
@@ -447,13 +425,13 @@ void QCustomPlotGraph::addData(double key, double value)
 void QCustomPlotGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
   int n = qMin(keys.size(), values.size());
-  QCustomPlotData newData;
+  QVector<QCustomPlotData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = keys.at(i);
-    newData.value = values.at(i);
-    mData->insertMulti(newData.key, newData);
+    newData[i].key = keys.at(i);
+    newData[i].value = values.at(i);
   }
+  mData->insert(newData);
 }
 
 /*!
@@ -462,9 +440,7 @@ void QCustomPlotGraph::addData(const QVector<double> &keys, const QVector<double
 */
 void QCustomPlotGraph::removeDataBefore(double key)
 {
-  QCustomPlotDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->remove(0, mData->lowerBound(key));
 }
 
 /*!
@@ -473,10 +449,7 @@ void QCustomPlotGraph::removeDataBefore(double key)
 */
 void QCustomPlotGraph::removeDataAfter(double key)
 {
-  if (mData->isEmpty()) return;
-  QCustomPlotDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->remove(mData->upperBound(key), mData->size());
 }
 
 /*!
@@ -488,10 +461,7 @@ void QCustomPlotGraph::removeDataAfter(double key)
 void QCustomPlotGraph::removeData(double fromKey, double toKey)
 {
   if (fromKey >= toKey || mData->isEmpty()) return;
-  QCustomPlotDataMap::iterator it = mData->upperBound(fromKey);
-  QCustomPlotDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->remove(mData->upperBound(fromKey), mData->upperBound(toKey));
 }
 
 /*!
@@ -502,7 +472,7 @@ void QCustomPlotGraph::removeData(double fromKey, double toKey)
 */
 void QCustomPlotGraph::removeData(double key)
 {
-  mData->remove(key);
+  mData->remove(mData->lowerBound(key), mData->upperBound(key));
 }
 
 /*!
@@ -783,7 +753,7 @@ void QCustomPlotGraph::getScatterPlotData(QVector<QCustomPlotData> *pointData) c
   if (!pointData) return;
   
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
   // prepare vectors:
@@ -791,8 +761,8 @@ void QCustomPlotGraph::getScatterPlotData(QVector<QCustomPlotData> *pointData) c
     pointData->resize(dataCount);
 
   // position data points:
-  QMap<double, QCustomPlotData>::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
   {
@@ -821,14 +791,28 @@ void QCustomPlotGraph::getScatterPlotData(QVector<QCustomPlotData> *pointData) c
   points that are visible, for drawing scatter points, if necessary. If drawing scatter points is
   disabled (i.e. scatter style \ref ssNone), pass 0 as \a pointData, and the function will skip
   filling the vector.
+
+  When no scatter points are needed and the visible points outnumber the pixels along the key
+  axis several times, the line is reduced by \ref getDecimatedLinePlotData.
   \see drawLinePlot
 */
 void QCustomPlotGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const
 {
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
+  // level of detail reduction, it yields up to four points per pixel column:
+  int keyPixels;
+  if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
+    keyPixels = mKeyAxis->axisRect().height();
+  else
+    keyPixels = mKeyAxis->axisRect().width();
+  if (lineData && !pointData && dataCount > 8*qMax(keyPixels, 1))
+  {
+    getDecimatedLinePlotData(lineData, lower, upper+1);
+    return;
+  }
   // prepare vectors:
   if (lineData)
   { 
@@ -840,8 +824,8 @@ void QCustomPlotGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCust
     pointData->resize(dataCount);
 
   // position data points:
-  QMap<double, QCustomPlotData>::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
   {
@@ -868,6 +852,65 @@ void QCustomPlotGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCust
   }
 }
 
+/*! 
+  \internal
+  Places a reduced line for the data points from \a begin up to, but not including, \a end in
+  \a lineData. The points falling into one pixel column of the key axis are replaced by at most
+  four: the first and the last one, which keep the lines to the neighbouring columns, and the ones
+  with the minimum and maximum value, all in their original order. So the drawn line covers the
+  same pixels while its length is bounded by the axis size rather than the number of points.
+  \see getLinePlotData
+*/
+void QCustomPlotGraph::getDecimatedLinePlotData(QVector<QPointF> *lineData, QCustomPlotDataArray::const_iterator begin, QCustomPlotDataArray::const_iterator end) const
+{
+  bool keyIsVertical = mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight;
+  lineData->clear();
+  
+  QCustomPlotDataArray::const_iterator it = begin;
+  while (it != end)
+  {
+    // gather the points of one pixel column:
+    int column = (int)floor(mKeyAxis->coordToPixel(it.key()));
+    int first = it.index();
+    int last = first;
+    int minIndex = first;
+    int maxIndex = first;
+    double minValue = mData->valueAt(first);
+    double maxValue = minValue;
+    ++it;
+    while (it != end && (int)floor(mKeyAxis->coordToPixel(it.key())) == column)
+    {
+      last = it.index();
+      double value = mData->valueAt(last);
+      if (value < minValue)
+      {
+        minValue = value;
+        minIndex = last;
+      }
+      if (value > maxValue)
+      {
+        maxValue = value;
+        maxIndex = last;
+      }
+      ++it;
+    }
+    
+    // emit them in index order, skipping repeated points:
+    int indices[4] = {first, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), last};
+    for (int k=0; k<4; ++k)
+    {
+      if (k > 0 && indices[k] == indices[k-1])
+        continue;
+      double key = mKeyAxis->coordToPixel(mData->keyAt(indices[k]));
+      double value = mValueAxis->coordToPixel(mData->valueAt(indices[k]));
+      if (keyIsVertical)
+        lineData->append(QPointF(value, key));
+      else
+        lineData->append(QPointF(key, value));
+    }
+  }
+}
+
 /*! 
   \internal
   Places the raw data points needed for a step plot with left oriented steps in \a lineData.
@@ -881,7 +924,7 @@ void QCustomPlotGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCust
 void QCustomPlotGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const
 {
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
   // prepare vectors:
@@ -896,8 +939,8 @@ void QCustomPlotGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<Q
     pointData->resize(dataCount);
   
   // position data points:
-  QMap<double, QCustomPlotData>::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   int ipoint = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
@@ -958,7 +1001,7 @@ void QCustomPlotGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<Q
 void QCustomPlotGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const
 {
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
   // prepare vectors:
@@ -973,8 +1016,8 @@ void QCustomPlotGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<
     pointData->resize(dataCount);
   
   // position points:
-  QMap<double, QCustomPlotData>::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   int ipoint = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
@@ -1035,7 +1078,7 @@ void QCustomPlotGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<
 void QCustomPlotGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const
 {
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
   // prepare vectors:
@@ -1050,8 +1093,8 @@ void QCustomPlotGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector
     pointData->resize(dataCount);
   
   // position points:
-  QCustomPlotDataMap::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   int ipoint = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
@@ -1138,7 +1181,7 @@ void QCustomPlotGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector
 void QCustomPlotGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const
 {
   // get visible data range:
-  QCustomPlotDataMap::const_iterator lower, upper;
+  QCustomPlotDataArray::const_iterator lower, upper;
   int dataCount;
   getVisibleDataBounds(lower, upper, dataCount);
   // prepare vectors:
@@ -1151,8 +1194,8 @@ void QCustomPlotGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QC
     pointData->resize(dataCount);
   
   // position data points:
-  QMap<double, QCustomPlotData>::const_iterator it = lower;
-  QCustomPlotDataMap::const_iterator upperEnd = upper+1;
+  QCustomPlotDataArray::const_iterator it = lower;
+  QCustomPlotDataArray::const_iterator upperEnd = upper+1;
   int i = 0;
   int ipoint = 0;
   if (mKeyAxis->axisType() == QCustomPlotAxis::atLeft || mKeyAxis->axisType() == QCustomPlotAxis::atRight)
@@ -1574,24 +1617,18 @@ void QCustomPlotGraph::drawLegendIcon(QPainter *painter, const QRect &rect) cons
   \param[out] count number of data points that need plotting, i.e. points between \a lower and \a upper,
   including them. This is useful for allocating the array of QPointFs in the specific drawing functions.
 */
-void QCustomPlotGraph::getVisibleDataBounds(QCustomPlotDataMap::const_iterator &lower, QCustomPlotDataMap::const_iterator &upper, int &count) const
+void QCustomPlotGraph::getVisibleDataBounds(QCustomPlotDataArray::const_iterator &lower, QCustomPlotDataArray::const_iterator &upper, int &count) const
 {
-  // get visible data range as QMap iterators
-  QCustomPlotDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis->range().lower);
-  QCustomPlotDataMap::const_iterator ubound = mData->upperBound(mKeyAxis->range().upper)-1;
+  // get visible data range by binary search over the sorted keys
+  QCustomPlotDataArray::const_iterator lbound = mData->constBegin() + mData->lowerBound(mKeyAxis->range().lower);
+  QCustomPlotDataArray::const_iterator ubound = mData->constBegin() + (mData->upperBound(mKeyAxis->range().upper)-1);
   bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
   bool highoutlier = ubound+1 != mData->constEnd(); // indicates whether there exist points above axis range
   lower = (lowoutlier ? lbound-1 : lbound); // data pointrange that will be actually drawn
   upper = (highoutlier ? ubound+1 : ubound); // data pointrange that will be actually drawn
   
   // count number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
-  QCustomPlotDataMap::const_iterator it = lower;
-  count = 1;
-  while (it != upper)
-  {
-    ++it;
-    ++count;
-  }
+  count = upper-lower+1;
 }
 
 /*! 
@@ -1970,7 +2007,7 @@ const QCustomPlotRange QCustomPlotGraph::getKeyRange(bool &validRange, bool incl
   
   if (restrictToSign == 0) // range may be anywhere
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().key;
@@ -1990,7 +2027,7 @@ const QCustomPlotRange QCustomPlotGraph::getKeyRange(bool &validRange, bool incl
     }
   } else if (restrictToSign < 0) // range may only be in the negative sign domain
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().key;
@@ -2023,7 +2060,7 @@ const QCustomPlotRange QCustomPlotGraph::getKeyRange(bool &validRange, bool incl
     }
   } else if (restrictToSign > 0) // range may only be in the positive sign domain
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().key;
@@ -2081,7 +2118,7 @@ const QCustomPlotRange QCustomPlotGraph::getValueRange(bool &validRange, bool in
   
   if (restrictToSign == 0) // range may be anywhere
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().value;
@@ -2101,7 +2138,7 @@ const QCustomPlotRange QCustomPlotGraph::getValueRange(bool &validRange, bool in
     }
   } else if (restrictToSign < 0) // range may only be in the negative sign domain
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().value;
@@ -2134,7 +2171,7 @@ const QCustomPlotRange QCustomPlotGraph::getValueRange(bool &validRange, bool in
     }
   } else if (restrictToSign > 0) // range may only be in the positive sign domain
   {
-    QCustomPlotDataMap::const_iterator it = mData->constBegin();
+    QCustomPlotDataArray::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
     {
       current = it.value().value;
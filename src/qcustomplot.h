@@ -41,17 +41,11 @@
 #include <QFlags>
 #include <cmath>
 
+#include "qcustomplotdata.h"
+
 class QCustomPlot;
 class QCustomPlotRange;
 class QCustomPlotAxis;
-class QCustomPlotData;
-
-/*! \typedef QCustomPlotDataMap
-  Container for storing QCustomPlotData items in a sorted fashion. The key of the map
-  is the key of the QCustomPlotData instance.
-  \see QCustomPlotData, QCustomPlotGraph::setData
-*/
-typedef QMap<double,QCustomPlotData> QCustomPlotDataMap;
 
 class QCustomPlotDataFetcher
 {
@@ -61,15 +55,6 @@ public:
 
 };
 
-class QCustomPlotData
-{
-public:
-  QCustomPlotData();
-  double key, value;
-  double keyErrorPlus, keyErrorMinus;
-  double valueErrorPlus, valueErrorMinus;
-};
-
 class QCustomPlotGraph
 {
 public:
@@ -130,7 +115,7 @@ public:
   bool visible() const { return mVisible; }
   QCustomPlotAxis *keyAxis() const { return mKeyAxis; }
   QCustomPlotAxis *valueAxis() const { return mValueAxis; }
-  const QCustomPlotDataMap *data() const { return mData; }
+  const QCustomPlotDataArray *data() const { return mData; }
   LineStyle lineStyle() const { return mLineStyle; }
   ScatterStyle scatterStyle() const { return mScatterStyle; }
   double scatterSize() const { return mScatterSize; }
@@ -185,7 +170,7 @@ protected:
   QCustomPlotAxis *mKeyAxis, *mValueAxis;
   QString mName;
   bool mVisible;
-  QMap<double, QCustomPlotData> *mData;
+  QCustomPlotDataArray *mData;
   QPen mPen, mErrorPen;
   QBrush mBrush;
   LineStyle mLineStyle;
@@ -205,6 +190,7 @@ protected:
   // plot style specific functions to generate plot data, used by getPlotData:
   void getScatterPlotData(QVector<QCustomPlotData> *pointData) const;
   void getLinePlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const;
+  void getDecimatedLinePlotData(QVector<QPointF> *lineData, QCustomPlotDataArray::const_iterator begin, QCustomPlotDataArray::const_iterator end) const;
   void getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const;
   void getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const;
   void getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCustomPlotData> *pointData) const;
@@ -222,7 +208,7 @@ protected:
   void drawLegendIcon(QPainter *painter, const QRect &rect) const;
 
   // helper functions:
-  void getVisibleDataBounds(QCustomPlotDataMap::const_iterator &lower, QCustomPlotDataMap::const_iterator &upper, int &count) const;
+  void getVisibleDataBounds(QCustomPlotDataArray::const_iterator &lower, QCustomPlotDataArray::const_iterator &upper, int &count) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -0,0 +1,300 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, a simple to use, modern plotting widget for Qt           **
+**  Copyright (C) 2011 Emanuel Eichhammer                                 **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.WorksLikeClockwork.com/                   **
+****************************************************************************/
+
+#include "qcustomplotdata.h"
+
+#include <algorithm>
+
+// ================================================================================
+// =================== QCustomPlotData
+// ================================================================================
+
+/*! \class QCustomPlotData
+  A class holding the data of one single data point.
+  \see QCustomPlotDataMap
+*/
+
+/*!
+  Constructs an empty data point with key, value and all errors set to zero.
+*/
+QCustomPlotData::QCustomPlotData() :
+  key(0),
+  value(0),
+  keyErrorPlus(0),
+  keyErrorMinus(0),
+  valueErrorPlus(0),
+  valueErrorMinus(0)
+{
+}
+
+// ================================================================================
+// =================== QCustomPlotDataArray
+// ================================================================================
+
+/*!
+  Returns the data point at index \a i, with zero errors if no errors are stored.
+*/
+QCustomPlotData QCustomPlotDataArray::at(int i) const
+{
+  QCustomPlotData data;
+  data.key = mKeys.at(i);
+  data.value = mValues.at(i);
+  if (hasErrors())
+  {
+    data.keyErrorPlus = mKeyErrorPlus.at(i);
+    data.keyErrorMinus = mKeyErrorMinus.at(i);
+    data.valueErrorPlus = mValueErrorPlus.at(i);
+    data.valueErrorMinus = mValueErrorMinus.at(i);
+  }
+  return data;
+}
+
+/*!
+  Removes all data points and releases the error arrays.
+*/
+void QCustomPlotDataArray::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mKeyErrorPlus.clear();
+  mKeyErrorMinus.clear();
+  mValueErrorPlus.clear();
+  mValueErrorMinus.clear();
+  mHasErrors = false;
+}
+
+/*!
+  Reserves memory for \a n data points.
+*/
+void QCustomPlotDataArray::reserve(int n)
+{
+  mKeys.reserve(n);
+  mValues.reserve(n);
+}
+
+/*! \internal
+  Returns the index at which a point with \a key is inserted, before the points with equal keys
+  as QMap::insertMulti does. Points arriving in ascending key order are appended without a search.
+*/
+int QCustomPlotDataArray::insertPosition(double key)
+{
+  if (mKeys.isEmpty() || key > mKeys.last())
+    return mKeys.size();
+  return lowerBound(key);
+}
+
+/*! \internal
+  Allocates the error arrays, zero for the points already stored, if \a withErrors and they are
+  not allocated yet.
+*/
+void QCustomPlotDataArray::allocateErrors(bool withErrors)
+{
+  if (withErrors && !hasErrors())
+  {
+    mKeyErrorPlus.fill(0, size());
+    mKeyErrorMinus.fill(0, size());
+    mValueErrorPlus.fill(0, size());
+    mValueErrorMinus.fill(0, size());
+    mHasErrors = true;
+  }
+}
+
+/*!
+  Inserts a data point without errors, keeping the points sorted by key.
+  
+  A point with a key smaller than the last one moves all points after it, so inserting many points
+  out of key order one by one takes quadratic time; use the overload taking a QVector instead.
+*/
+void QCustomPlotDataArray::insert(double key, double value)
+{
+  int i = insertPosition(key);
+  mKeys.insert(i, key);
+  mValues.insert(i, value);
+  if (hasErrors())
+  {
+    mKeyErrorPlus.insert(i, 0);
+    mKeyErrorMinus.insert(i, 0);
+    mValueErrorPlus.insert(i, 0);
+    mValueErrorMinus.insert(i, 0);
+  }
+}
+
+/*!
+  Inserts the data point \a data, keeping the points sorted by key. The error arrays are
+  allocated when the first point with a non-zero error is inserted.
+  
+  As for the other single point overload, inserting many points out of key order this way takes
+  quadratic time.
+*/
+void QCustomPlotDataArray::insert(const QCustomPlotData &data)
+{
+  allocateErrors(data.keyErrorPlus != 0 || data.keyErrorMinus != 0 ||
+                 data.valueErrorPlus != 0 || data.valueErrorMinus != 0);
+  int i = insertPosition(data.key);
+  mKeys.insert(i, data.key);
+  mValues.insert(i, data.value);
+  if (hasErrors())
+  {
+    mKeyErrorPlus.insert(i, data.keyErrorPlus);
+    mKeyErrorMinus.insert(i, data.keyErrorMinus);
+    mValueErrorPlus.insert(i, data.valueErrorPlus);
+    mValueErrorMinus.insert(i, data.valueErrorMinus);
+  }
+}
+
+/*! \internal
+  Orders data points by key only, for the stable sort of QCustomPlotDataArray::insert.
+*/
+static bool keyLessThan(const QCustomPlotData &a, const QCustomPlotData &b)
+{
+  return a.key < b.key;
+}
+
+/*!
+  Inserts the data points \a data in any key order with a single sort and merge, in O((n+m) +
+  m log m) time for n stored and m new points. The result is the same as inserting the points one
+  by one: points with equal keys end up in the reverse order of \a data, before the stored ones.
+*/
+void QCustomPlotDataArray::insert(const QVector<QCustomPlotData> &data)
+{
+  int m = data.size();
+  if (m == 0) return;
+  // the latest of equal keys first, as the stable sort keeps the order of the reversed points
+  QVector<QCustomPlotData> sorted(m);
+  bool withErrors = false;
+  for (int j=0; j<m; ++j)
+  {
+    const QCustomPlotData &d = data.at(m-1-j);
+    sorted[j] = d;
+    withErrors = withErrors || d.keyErrorPlus != 0 || d.keyErrorMinus != 0 ||
+                 d.valueErrorPlus != 0 || d.valueErrorMinus != 0;
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), keyLessThan);
+  allocateErrors(withErrors);
+
+  // merge from the back, the stored points of equal keys staying behind the new ones
+  int i = size()-1;
+  int k = size()+m-1;
+  mKeys.resize(k+1);
+  mValues.resize(k+1);
+  if (hasErrors())
+  {
+    mKeyErrorPlus.resize(k+1);
+    mKeyErrorMinus.resize(k+1);
+    mValueErrorPlus.resize(k+1);
+    mValueErrorMinus.resize(k+1);
+  }
+  for (int j=m-1; j>=0; --k)
+  {
+    const QCustomPlotData &d = sorted.at(j);
+    if (i >= 0 && mKeys.at(i) >= d.key)
+    {
+      mKeys[k] = mKeys.at(i);
+      mValues[k] = mValues.at(i);
+      if (hasErrors())
+      {
+        mKeyErrorPlus[k] = mKeyErrorPlus.at(i);
+        mKeyErrorMinus[k] = mKeyErrorMinus.at(i);
+        mValueErrorPlus[k] = mValueErrorPlus.at(i);
+        mValueErrorMinus[k] = mValueErrorMinus.at(i);
+      }
+      --i;
+    } else
+    {
+      mKeys[k] = d.key;
+      mValues[k] = d.value;
+      if (hasErrors())
+      {
+        mKeyErrorPlus[k] = d.keyErrorPlus;
+        mKeyErrorMinus[k] = d.keyErrorMinus;
+        mValueErrorPlus[k] = d.valueErrorPlus;
+        mValueErrorMinus[k] = d.valueErrorMinus;
+      }
+      --j;
+    }
+  }
+}
+
+/*!
+  Inserts the data points of \a map with a single merge, as QMap::unite does: points with equal
+  keys keep the order of the map, before the stored ones.
+*/
+void QCustomPlotDataArray::insert(const QCustomPlotDataMap &map)
+{
+  // reversed, so that the vector overload puts them back in the order of the map
+  QVector<QCustomPlotData> points(map.size());
+  int i = map.size();
+  QCustomPlotDataMap::const_iterator it = map.constBegin();
+  while (it != map.constEnd())
+  {
+    points[--i] = it.value();
+    ++it;
+  }
+  insert(points);
+}
+
+/*!
+  Removes the data points with indices from \a from up to, but not including, \a to.
+*/
+void QCustomPlotDataArray::remove(int from, int to)
+{
+  if (from >= to) return;
+  mKeys.remove(from, to-from);
+  mValues.remove(from, to-from);
+  if (hasErrors())
+  {
+    mKeyErrorPlus.remove(from, to-from);
+    mKeyErrorMinus.remove(from, to-from);
+    mValueErrorPlus.remove(from, to-from);
+    mValueErrorMinus.remove(from, to-from);
+  }
+}
+
+/*!
+  Returns the index of the first data point with a key not less than \a key, or \ref size if
+  there is none. Like QMap::lowerBound, but a binary search over the key array.
+*/
+int QCustomPlotDataArray::lowerBound(double key) const
+{
+  return std::lower_bound(mKeys.constBegin(), mKeys.constEnd(), key) - mKeys.constBegin();
+}
+
+/*!
+  Returns the index of the first data point with a key greater than \a key, or \ref size if
+  there is none.
+*/
+int QCustomPlotDataArray::upperBound(double key) const
+{
+  return std::upper_bound(mKeys.constBegin(), mKeys.constEnd(), key) - mKeys.constBegin();
+}
+
+/*!
+  Returns a copy of the data points as a QCustomPlotDataMap.
+*/
+QCustomPlotDataMap QCustomPlotDataArray::toMap() const
+{
+  QCustomPlotDataMap map;
+  for (int i=0; i<size(); ++i)
+    map.insertMulti(mKeys.at(i), at(i));
+  return map;
+}
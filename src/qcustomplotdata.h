@@ -0,0 +1,118 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, a simple to use, modern plotting widget for Qt           **
+**  Copyright (C) 2011 Emanuel Eichhammer                                 **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.WorksLikeClockwork.com/                   **
+**             Date: 19.11.11                                             **
+****************************************************************************/
+
+/*! \file */
+
+#ifndef QCUSTOMPLOTDATA_H
+#define QCUSTOMPLOTDATA_H
+
+#include <QVector>
+#include <QMap>
+
+class QCustomPlotData;
+
+/*! \typedef QCustomPlotDataMap
+  Container for storing QCustomPlotData items in a sorted fashion. The key of the map
+  is the key of the QCustomPlotData instance.
+  \see QCustomPlotData, QCustomPlotGraph::setData
+*/
+typedef QMap<double,QCustomPlotData> QCustomPlotDataMap;
+
+class QCustomPlotData
+{
+public:
+  QCustomPlotData();
+  double key, value;
+  double keyErrorPlus, keyErrorMinus;
+  double valueErrorPlus, valueErrorMinus;
+};
+
+/*! \class QCustomPlotDataArray
+  Sorted storage of the data points of a graph. Keys and values are kept in separate contiguous
+  arrays, the error arrays are only allocated once a point with errors is inserted. Points with
+  equal keys are ordered as QMap::insertMulti orders them, the latest inserted first.
+*/
+class QCustomPlotDataArray
+{
+public:
+  /*!
+    Read-only iterator with the interface of QCustomPlotDataMap::const_iterator that is used by
+    the drawing code.
+  */
+  class const_iterator
+  {
+  public:
+    const_iterator() : mArray(0), mIndex(0) {}
+    const_iterator(const QCustomPlotDataArray *array, int index) : mArray(array), mIndex(index) {}
+    double key() const { return mArray->keyAt(mIndex); }
+    QCustomPlotData value() const { return mArray->at(mIndex); }
+    int index() const { return mIndex; }
+    const_iterator &operator++() { ++mIndex; return *this; }
+    const_iterator operator++(int) { const_iterator old = *this; ++mIndex; return old; }
+    const_iterator &operator--() { --mIndex; return *this; }
+    const_iterator operator+(int n) const { return const_iterator(mArray, mIndex+n); }
+    const_iterator operator-(int n) const { return const_iterator(mArray, mIndex-n); }
+    int operator-(const const_iterator &other) const { return mIndex-other.mIndex; }
+    bool operator==(const const_iterator &other) const { return mIndex == other.mIndex; }
+    bool operator!=(const const_iterator &other) const { return mIndex != other.mIndex; }
+  private:
+    const QCustomPlotDataArray *mArray;
+    int mIndex;
+  };
+
+  QCustomPlotDataArray() : mHasErrors(false) {}
+
+  int size() const { return mKeys.size(); }
+  bool isEmpty() const { return mKeys.isEmpty(); }
+  bool hasErrors() const { return mHasErrors; }
+  double keyAt(int i) const { return mKeys.at(i); }
+  double valueAt(int i) const { return mValues.at(i); }
+  QCustomPlotData at(int i) const;
+
+  void clear();
+  void reserve(int n);
+  void insert(double key, double value);
+  void insert(const QCustomPlotData &data);
+  void insert(const QVector<QCustomPlotData> &data);
+  void insert(const QCustomPlotDataMap &map);
+  void remove(int from, int to);
+
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  const_iterator constBegin() const { return const_iterator(this, 0); }
+  const_iterator constEnd() const { return const_iterator(this, size()); }
+
+  QCustomPlotDataMap toMap() const;
+
+private:
+  int insertPosition(double key);
+  void allocateErrors(bool withErrors);
+
+  QVector<double> mKeys, mValues;
+  QVector<double> mKeyErrorPlus, mKeyErrorMinus;
+  QVector<double> mValueErrorPlus, mValueErrorMinus;
+  bool mHasErrors;
+};
+
+#endif // QCUSTOMPLOTDATA_H
@@ -0,0 +1,196 @@
+#include "renderer.h"
+#include "model.h"
+
+#include <qmath.h>
+
+Renderer::Renderer(Model *model)
+	: model(model)
+{
+	showBins = false;
+	electronStyle = Ellipses;
+	layerValid = false;
+	spriteR = -1;
+	traced = 0;
+	traceValid = false;
+
+	background = QBrush(Qt::white);
+	traceBrush = QBrush(Qt::black);
+	atomBrush = QBrush(Qt::black);
+	electronBrush = QBrush(Qt::red);
+	binBrush = QBrush(Qt::cyan);
+}
+
+void Renderer::setShowBins(bool val)
+{
+	showBins = val;
+	invalidate();
+}
+
+void Renderer::setElectronStyle(ElectronStyle style)
+{
+	electronStyle = style;
+}
+
+void Renderer::invalidate()
+{
+	layerValid = false;
+}
+
+void Renderer::invalidateTrace()
+{
+	traceValid = false;
+}
+
+void Renderer::paintTrace(QPainter *painter, int length, int step)
+{
+	int num = model->getNumber();
+	QSize size(model->getWidth(), model->getHeight());
+
+	if (!traceValid || trace.size() != size || num < traced) {
+		trace = QImage(size, QImage::Format_ARGB32_Premultiplied);
+		trace.fill(0);
+		traced = 0;
+		traceValid = true;
+	}
+	if (num > traced) {
+		extendTrace(traced, length, step);
+		traced = num;
+	}
+
+	painter->drawImage(0, 0, trace);
+}
+
+void Renderer::extendTrace(int first, int length, int step)
+{
+	// the electrons do not interact, so a model following only the new
+	// ones traces them and the displayed one stays untouched
+	Model ahead;
+	ahead.follow(*model, first);
+	ahead.setPaintTraceOnly(true);
+
+	QPainter painter(&trace);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setBrush(traceBrush);
+	for (int k = 0; k < length; k++) {
+		ahead.step(step);
+		ahead.sync();
+		const Particles& particles = ahead.getParticles();
+		for (int i = 0; i < ahead.getNumber(); i++) {
+			painter.drawEllipse(QPointF(particles.x[i], particles.y[i]), 1, 1);
+		}
+	}
+}
+
+void Renderer::paintLayer()
+{
+	int width = model->getWidth();
+	int height = model->getHeight();
+	qreal atomR = model->getAtomR();
+
+	layer = QPixmap(width, height);
+	QPainter painter(&layer);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.fillRect(QRect(0, 0, width, height), background);
+
+	if (showBins) {
+		int nbins = model->getBinsNumber();
+		qreal binwidth = model->getBinWidth();
+		painter.setBrush(binBrush);
+		for (int i = 1; i < nbins; i++) {
+			qreal y = binwidth*i;
+			painter.drawLine(QPointF(y, 0), QPointF(y, (qreal)height));
+		}
+		painter.fillRect(QRectF(binwidth*model->getBinIndex(), 0, binwidth, (qreal)height), binBrush);
+	}
+
+	QVector<QPointF> atoms = model->getAtomCentres();
+	painter.setBrush(atomBrush);
+	for (int i = 0; i < atoms.size(); i++)
+		painter.drawEllipse(atoms[i], atomR, atomR);
+
+	painter.end();
+	layerImage = layer.toImage().convertToFormat(QImage::Format_RGB32);
+	layerValid = true;
+}
+
+void Renderer::updateSprite(qreal r)
+{
+	if (r == spriteR)
+		return;
+	int size = 2*qCeil(r) + 2;
+	sprite = QPixmap(size, size);
+	sprite.fill(Qt::transparent);
+	QPainter painter(&sprite);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setBrush(electronBrush);
+	painter.drawEllipse(QPointF(size/2.0, size/2.0), r, r);
+	spriteR = r;
+}
+
+void Renderer::fillDisk(QImage& image, qreal cx, qreal cy, qreal r, QRgb color)
+{
+	int width = image.width();
+	int height = image.height();
+
+	// the centre pixel, so that tiny electrons stay visible
+	int px = qFloor(cx);
+	int py = qFloor(cy);
+	if (px >= 0 && px < width && py >= 0 && py < height)
+		((QRgb *)image.scanLine(py))[px] = color;
+
+	int top = qMax(0, qFloor(cy - r));
+	int bottom = qMin(height - 1, qFloor(cy + r));
+	for (int y = top; y <= bottom; y++) {
+		qreal dy = y + 0.5 - cy;
+		qreal h = r*r - dy*dy;
+		if (h < 0)
+			continue;
+		qreal dx = qSqrt(h);
+		int left = qMax(0, qRound(cx - dx));
+		int right = qMin(width - 1, qRound(cx + dx) - 1);
+		QRgb *line = (QRgb *)image.scanLine(y);
+		for (int x = left; x <= right; x++)
+			line[x] = color;
+	}
+}
+
+void Renderer::paint(QPainter *painter, QPaintEvent *event, const Particles& particles)
+{
+	qreal electronR = model->getElectronR();
+
+	if (!layerValid || layer.size() != QSize(model->getWidth(), model->getHeight()))
+		paintLayer();
+
+	painter->fillRect(event->rect(), background);
+
+	switch (electronStyle) {
+	case Ellipses:
+		painter->drawPixmap(0, 0, layer);
+		painter->save();
+		painter->setBrush(electronBrush);
+		for (int i = 0; i < particles.size(); i++) {
+			painter->drawEllipse(QPointF(particles.x[i], particles.y[i]), electronR, electronR);
+		}
+		painter->restore();
+		break;
+
+	case Sprites: {
+		painter->drawPixmap(0, 0, layer);
+		updateSprite(electronR);
+		int half = sprite.width() / 2;
+		for (int i = 0; i < particles.size(); i++) {
+			painter->drawPixmap(qRound(particles.x[i]) - half, qRound(particles.y[i]) - half, sprite);
+		}
+		break;
+	}
+
+	case Pixels: {
+		QImage frame = layerImage;
+		QRgb color = electronBrush.color().rgb();
+		for (int i = 0; i < particles.size(); i++)
+			fillDisk(frame, particles.x[i], particles.y[i], electronR, color);
+		painter->drawImage(0, 0, frame);
+		break;
+	}
+	}
+}
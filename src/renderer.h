@@ -0,0 +1,77 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <QBrush>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPixmap>
+#include <QImage>
+
+class Model;
+class Particles;
+
+/*
+ * Draws the state of a Model: the lattice, the bins and the electrons.
+ */
+class Renderer
+{
+public:
+	enum ElectronStyle {
+		Ellipses,	// antialiased ellipse per electron
+		Sprites,	// blit of a pre-rendered electron
+		Pixels		// disks rasterised straight into the frame image
+	};
+
+	Renderer(Model *model);
+
+	// The electrons are drawn at the given positions,
+	// the rest is taken from the model
+	void paint(QPainter *painter, QPaintEvent *event, const Particles& particles);
+
+	// Draws where the electrons will be over the next length steps of
+	// step milliseconds. The trace is kept in an image and only the
+	// electrons added since the last call are followed, on a model
+	// set up from this one while the caller holds it.
+	void paintTrace(QPainter *painter, int length, int step);
+
+	void setShowBins(bool);
+	void setElectronStyle(ElectronStyle);
+
+	// The background, bins and atoms are drawn once into a cached layer.
+	// Must be called when the lattice, the size or the bins change.
+	void invalidate();
+
+	// Must be called when the electrons move or the parameters
+	// of their motion change.
+	void invalidateTrace();
+
+private:
+	void paintLayer();
+	void updateSprite(qreal r);
+	void extendTrace(int first, int length, int step);
+	static void fillDisk(QImage& image, qreal cx, qreal cy, qreal r, QRgb color);
+
+	Model *model;
+
+	QBrush background;
+	QBrush traceBrush;
+	QBrush atomBrush;
+	QBrush electronBrush;
+	QBrush binBrush;
+
+	bool showBins;
+	ElectronStyle electronStyle;
+
+	QPixmap layer;
+	QImage layerImage;
+	bool layerValid;
+
+	QPixmap sprite;
+	qreal spriteR;
+
+	QImage trace;
+	int traced;		// electrons already drawn in the trace
+	bool traceValid;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "simulation.h"
+#include "model.h"
+
+const int Simulation::publishPeriod = 20;
+
+Simulation::Simulation(Model *model, QObject *parent)
+	: QThread(parent), model(model)
+{
+	playing = false;
+	quitting = false;
+	step = 50;
+	interval = 50;
+	back = 0;
+	middle = 1;
+	front = 2;
+
+	points = 0;
+	generation = 0;
+	revision = 0;
+	sincePublish.start();
+}
+
+Simulation::~Simulation()
+{
+	acquire();
+	quitting = true;
+	release();
+	wait();
+}
+
+void Simulation::setStep(int ms)
+{
+	acquire();
+	step = ms;
+	release();
+}
+
+void Simulation::setInterval(int ms)
+{
+	acquire();
+	interval = ms;
+	release();
+}
+
+bool Simulation::isPlaying() const
+{
+	acquire();
+	bool set = playing;
+	release();
+	return set;
+}
+
+void Simulation::play()
+{
+	acquire();
+	playing = true;
+	release();
+}
+
+void Simulation::pause()
+{
+	acquire();
+	playing = false;
+	publish();
+	release();
+}
+
+void Simulation::lock()
+{
+	acquire();
+}
+
+void Simulation::unlock()
+{
+	publish();
+	release();
+}
+
+/*
+ * Takes the mutex from the running thread. QMutex is not fair and the
+ * thread locks it again right after its step when it runs as fast as
+ * possible, so it gives way to the waiting callers it sees counted.
+ */
+void Simulation::acquire() const
+{
+	requests.ref();
+	mutex.lock();
+	requests.deref();
+}
+
+// Hands the mutex back and wakes the thread if it gave way
+void Simulation::release() const
+{
+	mutex.unlock();
+	wake.wakeAll();
+}
+
+const Simulation::Snapshot& Simulation::snapshot()
+{
+	// ordered exchanges: each side hands a buffer over and takes one back
+	if (middle.fetchAndAddAcquire(0) & Fresh)
+		front = middle.fetchAndStoreOrdered(front) & IndexMask;
+	return buffers[front];
+}
+
+/*
+ * Copies the state of the model into the back buffer and hands it over
+ * to the reader, the mutex must be held.
+ */
+void Simulation::publish()
+{
+	model->sync();
+
+	// only the new points are copied, unless the model has trimmed or
+	// cleared its series; the history read by the display is left as is
+	Model::SeriesView series = model->getSeries();
+	if (history.isNull() || series.revision != revision) {
+		int capacity = model->getHistoryCapacity();
+		history = QSharedPointer<History>(new History);
+		history->time = QVector<qreal>(capacity);
+		history->prob = QVector<qreal>(capacity);
+		history->impulses = QVector<qreal>(capacity);
+		revision = series.revision;
+		points = 0;
+		generation++;
+	}
+	for (int i = points; i < series.size; i++) {
+		history->time[i] = series.time[i];
+		history->prob[i] = series.prob[i];
+		history->impulses[i] = series.impulses[i];
+	}
+	points = series.size;
+
+	Snapshot& snap = buffers[back];
+	snap.particles = model->getParticles();
+	// copied into the buffer's own vector: sharing the model's one would
+	// make the model copy it at its next measurement, on the worker thread
+	QVector<qreal> density = model->getDensity();
+	snap.density.resize(density.size());
+	for (int b = 0; b < density.size(); b++)
+		snap.density[b] = density[b];
+	snap.history = history;
+	snap.points = points;
+	snap.generation = generation;
+
+	back = middle.fetchAndStoreOrdered(back | Fresh) & IndexMask;
+	sincePublish.restart();
+}
+
+void Simulation::run()
+{
+	mutex.lock();
+	forever {
+		while (!quitting && (!playing || requests.fetchAndAddRelaxed(0) > 0))
+			wake.wait(&mutex);
+		if (quitting)
+			break;
+
+		model->step(step);
+		if (sincePublish.elapsed() >= publishPeriod)
+			publish();
+
+		int pause = interval;
+		mutex.unlock();
+		if (pause > 0)
+			msleep(pause);
+		mutex.lock();
+	}
+	mutex.unlock();
+}
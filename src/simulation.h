@@ -0,0 +1,111 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "particles.h"
+
+class Model;
+
+/*
+ * Steps a Model on its own thread, independently of the display, and
+ * publishes snapshots of its state.  The display only reads snapshots;
+ * the model itself is changed between lock() and unlock().
+ *
+ * Snapshots are exchanged through a triple buffer: the publisher fills
+ * the back buffer and swaps it with the middle one, the reader swaps the
+ * middle buffer with the front one when it is fresh.  Neither side waits
+ * for the other and the reader never sees a half written snapshot.
+ */
+class Simulation : public QThread
+{
+	Q_OBJECT
+
+public:
+	// Measured points published so far. A history is only appended to and
+	// its arrays are never resized, so the reader uses the points below
+	// Snapshot::points without copying. When the model trims or clears its
+	// series, a new history is started.
+	struct History {
+		QVector<qreal> time;
+		QVector<qreal> prob;
+		QVector<qreal> impulses;
+	};
+
+	// State of the model at one moment
+	struct Snapshot {
+		Snapshot() : points(0), generation(0) {}
+
+		Particles particles;
+		QVector<qreal> density;
+		QSharedPointer<const History> history;
+		int points;		// measured points published in the history
+		int generation;	// changes with the history
+	};
+
+	Simulation(Model *model, QObject *parent = 0);
+	~Simulation();
+
+	// Model time of one step in milliseconds
+	void setStep(int ms);
+	// Pause between the steps in milliseconds, 0 to run as fast as possible
+	void setInterval(int ms);
+
+	bool isPlaying() const;
+
+	// Waits for the current step, the snapshot is refreshed on unlock
+	void lock();
+	void unlock();
+
+	// Latest published snapshot. There must be a single reader thread and
+	// the reference is valid until its next call.
+	const Snapshot& snapshot();
+
+	// Minimal time between two snapshots published by the thread, ms
+	static const int publishPeriod;
+
+public slots:
+	void play();
+	void pause();
+
+protected:
+	void run();
+
+private:
+	Q_DISABLE_COPY(Simulation)
+
+	void acquire() const;
+	void release() const;
+	void publish();
+
+	Model *model;
+
+	mutable QMutex mutex;		// guards the model and the settings
+	mutable QWaitCondition wake;
+	mutable QAtomicInt requests;	// callers waiting for the thread to give way
+	bool playing;
+	bool quitting;
+	int step;
+	int interval;
+
+	enum { IndexMask = 3, Fresh = 4 };
+
+	Snapshot buffers[3];
+	int back;			// filled by the publisher
+	QAtomicInt middle;	// index of the exchanged buffer, | Fresh if unread
+	int front;			// read by the reader
+
+	QSharedPointer<History> history;
+	int points;			// points copied to the history
+	int generation;
+	int revision;		// of the model series copied to the history
+	QElapsedTimer sincePublish;
+};
+
+#endif
@@ -2,30 +2,50 @@
 #include "window.h"
 #include "widget.h"
 #include "model.h"
+#include "simulation.h"
 
 static const int w = 400;
 static const int h = 400;
 
-Widget::Widget(Model *model, QWidget *parent)
-	: QWidget(parent), model(model)
+Widget::Widget(Model *model, Simulation *simulation, QWidget *parent)
+	: QWidget(parent), model(model), simulation(simulation), renderer(model),
+	random(QDateTime::currentMSecsSinceEpoch(), 0)
 {
 	showTrace = false;
 	elapsed = 0;
 	setFixedSize(w, h);
+	simulation->lock();
 	model->setDim(w, h);
+	simulation->unlock();
 	vecBegin = QPoint(-1, -1);
 	vecBrush = QBrush(Qt::green);
 }
 
 void Widget::animate()
 {
-	model->step(refresh_rate);
+	renderer.invalidateTrace();
 	repaint();
 }
 
 void Widget::setTrace(bool set)
 {
 	showTrace = set;
+	renderer.invalidateTrace();
+	repaint();
+}
+
+void Widget::setEventDriven(bool set)
+{
+	simulation->lock();
+	model->setEngine(set ? Model::EventDrivenEngine : Model::TimeStepEngine);
+	simulation->unlock();
+	renderer.invalidateTrace();
+	repaint();
+}
+
+void Widget::setElectronStyle(int style)
+{
+	renderer.setElectronStyle((Renderer::ElectronStyle)style);
 	repaint();
 }
 
@@ -34,26 +54,17 @@ void Widget::paintEvent(QPaintEvent *event)
 	painter.begin(this);
 	painter.setRenderHint(QPainter::Antialiasing);
 
-	model->paint(&painter, event);
+	const Simulation::Snapshot& snapshot = simulation->snapshot();
+	renderer.paint(&painter, event, snapshot.particles);
 	if (vecBegin.x() >= 0) {
 		painter.setBrush(vecBrush);
 		painter.drawLine(vecBegin, vecEnd);
 	}
 
 	if (showTrace) {
-		int sum = 0;
-		int step = refresh_rate;
-		int length = trace_length/refresh_rate;
-
-		model->save();
-		model->setPaintTraceOnly(true);
-		for (int i = 1; i <= length; i++) {
-			sum += step;
-			model->step(step);
-			model->paint(&painter, event);
-		}
-		model->setPaintTraceOnly(false);
-		model->load();
+		simulation->lock();
+		renderer.paintTrace(&painter, trace_length/refresh_rate, refresh_rate);
+		simulation->unlock();
 	}
 
 	painter.end();
@@ -82,10 +93,12 @@ void Widget::mouseReleaseEvent(QMouseEvent *event)
 	else
 		// The direction is default
 		if (randomDefDir)
-			angle = (2*M_PI / 360) * (rand() % 360);
+			angle = 2*M_PI * random.uniform();
 		else
 			angle = (2*M_PI / 360) * (defDir - 90);
+	simulation->lock();
 	model->add(vecBegin.x(), vecBegin.y(), angle);
+	simulation->unlock();
 	vecBegin = QPoint(-1, -1);
 	repaint();
 	numberChanged(model->getNumber());
@@ -100,49 +113,91 @@ QImage Widget::getImage()
 
 void Widget::setNumber(int num)
 {
+	simulation->lock();
 	model->setNumber(num);
+	simulation->unlock();
 	repaint();
 }
 
 void Widget::setSide(int val)
 {
+	simulation->lock();
 	model->setSide(val);
+	simulation->unlock();
+	renderer.invalidate();
+	renderer.invalidateTrace();
+	repaint();
+}
+
+void Widget::setLattice(int geometry)
+{
+	simulation->lock();
+	model->setGeometry((Model::Geometry)geometry);
+	simulation->unlock();
+	renderer.invalidate();
+	renderer.invalidateTrace();
+	repaint();
+}
+
+void Widget::setPeriodic(bool periodic)
+{
+	simulation->lock();
+	model->setBoundary(periodic ? Model::PeriodicBoundary : Model::ReflectingBoundary);
+	simulation->unlock();
+	renderer.invalidate();
+	renderer.invalidateTrace();
 	repaint();
 }
 
 void Widget::setAtomR(double val)
 {
+	simulation->lock();
 	model->setAtomR((qreal)val);
+	simulation->unlock();
+	renderer.invalidate();
+	renderer.invalidateTrace();
 	repaint();
 }
 
 void Widget::setElectronR(double val)
 {
+	simulation->lock();
 	model->setElectronR((qreal)val);
+	simulation->unlock();
+	renderer.invalidateTrace();
 	repaint();
 }
 
 void Widget::setSpeed(double val)
 {
+	simulation->lock();
 	model->setSpeed(val);
+	simulation->unlock();
+	renderer.invalidateTrace();
 	repaint();
 }
 
 void Widget::setShowBins(bool val)
 {
-	model->setShowBins(val);
+	renderer.setShowBins(val);
 	repaint();
 }
 
 void Widget::setBinsNumber(int val)
 {
+	simulation->lock();
 	model->setBinsNumber(val);
+	simulation->unlock();
+	renderer.invalidate();
 	repaint();
 }
 
 void Widget::setBinIndex(int val)
 {
+	simulation->lock();
 	model->setBinIndex(val-1);
+	simulation->unlock();
+	renderer.invalidate();
 	repaint();
 }
 
@@ -158,5 +213,7 @@ void Widget::setDefaultRandom(bool isRandom)
 
 void Widget::clear()
 {
+	simulation->lock();
 	model->clear();
+	simulation->unlock();
 }
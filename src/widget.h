@@ -6,20 +6,26 @@
 #include <QPainter>
 #include <QImage>
 
+#include "renderer.h"
+#include "random.h"
+
 class Model;
+class Simulation;
 
 class Widget : public QWidget
 {
 	Q_OBJECT
 
 public:
-	Widget(Model *model, QWidget *parent);
+	Widget(Model *model, Simulation *simulation, QWidget *parent);
 	QImage getImage();
 
 public slots:
 	void animate();
 	void setNumber(int);
 	void setSide(int);
+	void setLattice(int);
+	void setPeriodic(bool);
 	void setSpeed(double);
 	void setAtomR(double);
 	void setElectronR(double);
@@ -29,6 +35,8 @@ public slots:
 	void setDefaultDirection(double);
 	void setDefaultRandom(bool);
 	void setTrace(bool);
+	void setEventDriven(bool);
+	void setElectronStyle(int);
 	void clear();
 
 signals:
@@ -43,6 +51,8 @@ protected:
 private:
 	QPainter painter;
 	Model *model;
+	Simulation *simulation;	// the model is only changed while it is locked
+	Renderer renderer;
 	int elapsed;
 
 	QPoint vecBegin, vecEnd;
@@ -50,6 +60,7 @@ private:
 
 	qreal defDir;
 	bool randomDefDir;
+	Random random;		// default directions of clicked electrons
 	bool showTrace;
 };
 
@@ -7,7 +7,7 @@
 
 Window::Window(QWidget *parent)
 	: QMainWindow(parent),
-	ui(new Ui::Window)
+	ui(new Ui::Window), simulation(&model)
 {
 	ui->setupUi(this);
 	setWindowTitle(tr("Physics"));
@@ -23,7 +23,7 @@ Window::Window(QWidget *parent)
 	plot = new QCustomPlot(this);
 	ui->plotLayout->addWidget(plot);
 
-	native = new Widget(&model, this);
+	native = new Widget(&model, &simulation, this);
 	ui->nativeLayout->addWidget(native, 0, 0);
 
 	timer = new QTimer(this);
@@ -31,6 +31,12 @@ Window::Window(QWidget *parent)
 	connect(timer, SIGNAL(timeout()), native, SLOT(animate()));
 	connect(timer, SIGNAL(timeout()), this, SLOT(replot()));
 	wasRunning = false;
+	plottedKind = ProbabilityPlot;
+	plottedGeneration = -1;
+	plotted = 0;
+
+	simulation.setStep(refresh_rate);
+	simulation.start();
 
 	connect(ui->togglePlayButton, SIGNAL(clicked()), this, SLOT(togglePlay()));
 	connect(ui->clearButton, SIGNAL(clicked()), this, SLOT(clearSettings()));
@@ -40,6 +46,7 @@ Window::Window(QWidget *parent)
 	connect(native, SIGNAL(numberChanged(int)), ui->numberBox, SLOT(setValue(int)));
 	connect(ui->numberBox, SIGNAL(valueChanged(int)), native, SLOT(setNumber(int)));
 	connect(ui->sideBox, SIGNAL(valueChanged(int)), native, SLOT(setSide(int)));
+	connect(ui->latticeBox, SIGNAL(currentIndexChanged(int)), native, SLOT(setLattice(int)));
 	connect(ui->atomRadBox, SIGNAL(valueChanged(double)), native, SLOT(setAtomR(double)));
 	connect(ui->electronRadBox, SIGNAL(valueChanged(double)), native, SLOT(setElectronR(double)));
 	connect(ui->speedBox, SIGNAL(valueChanged(double)), native, SLOT(setSpeed(double)));
@@ -48,19 +55,28 @@ Window::Window(QWidget *parent)
 	connect(ui->binIndexBox, SIGNAL(valueChanged(int)), native, SLOT(setBinIndex(int)));
 	connect(ui->defDirBox, SIGNAL(valueChanged(double)), native, SLOT(setDefaultDirection(double)));
 	connect(ui->randomDefDirBox, SIGNAL(toggled(bool)), native, SLOT(setDefaultRandom(bool)));
+	connect(ui->eventDrivenCheckBox, SIGNAL(toggled(bool)), native, SLOT(setEventDriven(bool)));
+	connect(ui->electronStyleBox, SIGNAL(currentIndexChanged(int)), native, SLOT(setElectronStyle(int)));
+	connect(ui->fastRunCheckBox, SIGNAL(toggled(bool)), this, SLOT(setFastRun(bool)));
+	connect(ui->periodicCheckBox, SIGNAL(toggled(bool)), native, SLOT(setPeriodic(bool)));
 
 	plot->xAxis->setRange(0, 1000);
 	plot->yAxis->setRange(0, 1);
 
 	native->setNumber(ui->numberBox->value());
 	native->setSide(ui->sideBox->value());
+	native->setLattice(ui->latticeBox->currentIndex());
+	native->setPeriodic(ui->periodicCheckBox->isChecked());
 	native->setAtomR(ui->atomRadBox->value());
 	native->setElectronR(ui->electronRadBox->value());
 	native->setSpeed(ui->speedBox->value());
 	native->setShowBins(ui->showBinsBox->checkState());
 	native->setDefaultDirection(ui->defDirBox->value());
 	native->setDefaultRandom(ui->randomDefDirBox->checkState());
+	native->setEventDriven(ui->eventDrivenCheckBox->isChecked());
+	native->setElectronStyle(ui->electronStyleBox->currentIndex());
 	updateBinsNumber(ui->binsBox->value());
+	setFastRun(ui->fastRunCheckBox->isChecked());
 
 	trailMode(ui->trailModeCheckBox->checkState());
 	updateTogglePlayButton();
@@ -69,28 +85,57 @@ Window::Window(QWidget *parent)
 	adjustSize();
 }
 
+Window::PlotKind Window::plotKind() const
+{
+	if (ui->plotProbabilityButton->isChecked())
+		return ProbabilityPlot;
+	else if (ui->plotPressureButton->isChecked())
+		return PressurePlot;
+	else
+		return DensityPlot;
+}
+
 void Window::replot()
 {
-	plot->clearGraphs();
+	const Simulation::Snapshot& snapshot = simulation.snapshot();
+	const Simulation::History *history = snapshot.history.data();
+	PlotKind kind = plotKind();
+
+	// the series only grow, so just the new points are added to the graph;
+	// the density has a few bins and is redrawn every time
+	if (kind != plottedKind || kind == DensityPlot ||
+		snapshot.generation != plottedGeneration || plot->graphCount() == 0) {
+		plot->clearGraphs();
+		plot->addGraph();
+		plottedKind = kind;
+		plottedGeneration = snapshot.generation;
+		plotted = 0;
+		ymin = 100500.0;
+		ymax = -100500.0;
+	}
 
 	QVector<qreal> x;
 	QVector<qreal> y;
-	if (ui->plotProbabilityButton->isChecked())
+	if (kind == ProbabilityPlot)
 	{
-		x = model.getTime();
-		y = model.getProb();
+		for (int i = plotted; i < snapshot.points; i++) {
+			x.push_back(history->time[i]);
+			y.push_back(history->prob[i]);
+		}
+		plotted = snapshot.points;
 		plot->yAxis->setLabel("probability");
 	}
-	else if (ui->plotPressureButton->isChecked())
+	else if (kind == PressurePlot)
 	{
-		x = model.getTime();
-		y = model.getImpulses();
-		for (int i = 0; i < x.size(); i++)
-			y[i] = y[i] / x[i];
+		for (int i = plotted; i < snapshot.points; i++) {
+			x.push_back(history->time[i]);
+			y.push_back(history->impulses[i] / history->time[i]);
+		}
+		plotted = snapshot.points;
 		plot->yAxis->setLabel("pressure");
 	}
 	else { // density plot
-		QVector<qreal> binProb = model.getDensity();
+		const QVector<qreal>& binProb = snapshot.density;
 		qreal binWidth = 1.0/binProb.size();
 		for (int b = 0; b < binProb.size(); ++b) {
 			x.push_back(b*binWidth);
@@ -98,20 +143,21 @@ void Window::replot()
 			x.push_back((b+1)*binWidth-1e-3);
 			y.push_back(binProb[b]);
 		}
+		plotted = x.size();
 		plot->yAxis->setLabel("density");
 	}
 
 	plot->xAxis->setLabel("t");
 
-	plot->addGraph();
-	plot->graph(0)->setData(x, y);
+	if (plotted == 0)
+		return;
+	plot->graph(0)->addData(x, y);
 
-	qreal xmax = x.last();
-	qreal xmin = x.first();
-	plot->xAxis->setRange(xmin, xmax);
+	if (kind == DensityPlot)
+		plot->xAxis->setRange(x.first(), x.last());
+	else
+		plot->xAxis->setRange(history->time[0], history->time[plotted-1]);
 
-	qreal ymax = -100500.0;
-	qreal ymin = 100500.0;
 	for (int i = 0; i < y.size(); i++) {
 		if (y[i] > ymax)
 			ymax = y[i];
@@ -120,9 +166,9 @@ void Window::replot()
 	}
 	qreal gap = (ymax-ymin)*0.05;
 
-	if (ui->plotProbabilityButton->isChecked())
+	if (kind == ProbabilityPlot)
 		plot->yAxis->setRange(0.0, 1.0);
-	else if (ui->plotDensityButton->isChecked())
+	else if (kind == DensityPlot)
 		plot->yAxis->setRange(0.0, (2*ymax < 1.0 ? 2*ymax : 1.0));
 	else
 		plot->yAxis->setRange(ymin-gap, ymax+gap);
@@ -137,10 +183,14 @@ void Window::saveShot()
 
 void Window::togglePlay()
 {
-	if (timer->isActive())
+	if (timer->isActive()) {
 		timer->stop();
-	else
+		simulation.pause();
+	}
+	else {
+		simulation.play();
 		timer->start();
+	}
 	updateTogglePlayButton();
 }
 
@@ -152,6 +202,12 @@ void Window::updateTogglePlayButton()
 		ui->togglePlayButton->setText(tr("Play"));
 }
 
+void Window::setFastRun(bool fast)
+{
+	// the simulated time runs at the wall clock rate unless fast
+	simulation.setInterval(fast ? 0 : refresh_rate);
+}
+
 void Window::updateBinsNumber(int num)
 {
 	ui->binIndexBox->setMaximum(num);
@@ -163,8 +219,9 @@ void Window::clearSettings()
 	ui->trailModeCheckBox->setChecked(false);
 	ui->numberBox->setValue(0);
 	timer->stop();
+	simulation.pause();
 	updateTogglePlayButton();
-	model.clear();
+	native->clear();
 	plot->clearGraphs();
 	plot->xAxis->setRange(0, 1000);
 	plot->yAxis->setRange(0, 1);
@@ -178,13 +235,16 @@ void Window::trailMode(bool active)
 		else
 			wasRunning = false;
 		timer->stop();
+		simulation.pause();
 		ui->togglePlayButton->setEnabled(false);
 		native->setTrace(true);
 	}
 	else {
 		native->setTrace(false);
-		if (wasRunning)
+		if (wasRunning) {
+			simulation.play();
 			timer->start();
+		}
 		ui->togglePlayButton->setEnabled(true);
 	}
 }
@@ -6,6 +6,7 @@
 #include <QTimer>
 
 #include "model.h"
+#include "simulation.h"
 #include "widget.h"
 #include "aboutdialog.h"
 #include "qcustomplot.h"
@@ -34,20 +35,31 @@ protected slots:
 	void clearSettings();
 	void updateTogglePlayButton();
 	void updateBinsNumber(int);
+	void setFastRun(bool);
 	void trailMode(bool active);
 
 private:
+	enum PlotKind { ProbabilityPlot, PressurePlot, DensityPlot };
+	PlotKind plotKind() const;
+
 	Ui::Window *ui;
 
 	Model model;
+	Simulation simulation;	// declared after the model, stops before it is destroyed
 
-	QTimer *timer;
+	QTimer *timer;		// refreshes the display while playing
 	Widget *native;
 	QCustomPlot* plot;
 
 	AboutDialog *aboutDialog;
 
 	bool wasRunning;
+
+	// what the graph shows, extended by replot()
+	PlotKind plottedKind;
+	int plottedGeneration;
+	int plotted;		// points in the graph
+	qreal ymin, ymax;
 };
 
 #endif
@@ -0,0 +1,43 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+/*
+ * Minimal test harness: a test is a function returning true on success,
+ * listed in main.cpp. CHECK reports the failed condition and fails it.
+ */
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			return false; \
+		} \
+	} while (0)
+
+// random_test.cpp
+bool testPhiloxKnownAnswers();
+bool testRandomStreams();
+
+// scatterers_test.cpp
+bool testScattererGrid();
+bool testScattererGridScales();
+
+// periodic_test.cpp
+bool testPeriodicGrid();
+bool testPeriodicEngines();
+bool testPeriodicCorridor();
+
+// model_test.cpp
+bool testModelFollow();
+bool testModelBinSum();
+bool testModelBinSplit();
+bool testModelDensities();
+
+// ensemble_test.cpp
+bool testEnsembleWelford();
+
+// qcustomplotdata_test.cpp
+bool testDataArrayInsert();
+
+#endif
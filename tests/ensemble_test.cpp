@@ -0,0 +1,65 @@
+#include <qmath.h>
+
+#include "check.h"
+#include "ensemble.h"
+#include "model.h"
+
+namespace {
+
+bool close(qreal a, qreal b)
+{
+	return qAbs(a - b) <= 1e-12 * (1 + qAbs(b));
+}
+
+// Checks series at point i against the mean and the sample variance of
+// values, taken in two passes
+bool matches(const Ensemble::Series& series, int i, const QVector<qreal>& values)
+{
+	int n = values.size();
+	qreal mean = 0;
+	for (int r = 0; r < n; r++)
+		mean += values[r];
+	mean /= n;
+	qreal variance = 0;
+	for (int r = 0; r < n; r++)
+		variance += (values[r] - mean) * (values[r] - mean);
+	variance /= n - 1;
+	return close(series.mean[i], mean) && close(series.variance[i], variance);
+}
+
+}
+
+// The running mean and variance over the replicas agree with two passes
+// over the values of each replica, at every point and in every bin
+bool testEnsembleWelford()
+{
+	Parameters p;
+	p.num = 200;
+	p.nbins = 4;
+	Ensemble ensemble(p, 5);
+	ensemble.run(3000, 50);
+
+	int replicas = ensemble.getReplicas();
+	QVector<qreal> time = ensemble.getTime();
+	Ensemble::Series prob = ensemble.getProb();
+	QVector<Ensemble::Series> density = ensemble.getDensity();
+	CHECK(time.size() > 10);
+	CHECK(prob.mean.size() == time.size());
+	CHECK(density.size() == p.nbins);
+
+	QVector<qreal> values(replicas);
+	for (int i = 0; i < time.size(); i++) {
+		for (int r = 0; r < replicas; r++)
+			values[r] = ensemble.getReplica(r).getProb()[i];
+		CHECK(matches(prob, i, values));
+		for (int b = 0; b < p.nbins; b++) {
+			CHECK(density[b].mean.size() == time.size());
+			for (int r = 0; r < replicas; r++)
+				values[r] = ensemble.getReplica(r).getDensities()[i][b];
+			CHECK(matches(density[b], i, values));
+		}
+	}
+	// the replicas differ, or the variances would not be checked
+	CHECK(prob.variance.last() > 0);
+	return true;
+}
@@ -0,0 +1,38 @@
+#include <stdio.h>
+
+#include "check.h"
+
+struct Test {
+	const char *name;
+	bool (*run)();
+};
+
+static const Test tests[] = {
+	{ "PhiloxKnownAnswers", testPhiloxKnownAnswers },
+	{ "RandomStreams", testRandomStreams },
+	{ "ScattererGrid", testScattererGrid },
+	{ "ScattererGridScales", testScattererGridScales },
+	{ "PeriodicGrid", testPeriodicGrid },
+	{ "PeriodicEngines", testPeriodicEngines },
+	{ "PeriodicCorridor", testPeriodicCorridor },
+	{ "ModelFollow", testModelFollow },
+	{ "ModelBinSum", testModelBinSum },
+	{ "ModelBinSplit", testModelBinSplit },
+	{ "ModelDensities", testModelDensities },
+	{ "EnsembleWelford", testEnsembleWelford },
+	{ "DataArrayInsert", testDataArrayInsert }
+};
+
+int main()
+{
+	int failed = 0;
+	int count = sizeof(tests) / sizeof(tests[0]);
+	for (int i = 0; i < count; i++) {
+		bool passed = tests[i].run();
+		printf("%s %s\n", passed ? "PASS" : "FAIL", tests[i].name);
+		if (!passed)
+			failed++;
+	}
+	printf("%d of %d tests passed\n", count - failed, count);
+	return failed;
+}
@@ -0,0 +1,148 @@
+#include <qmath.h>
+
+#include "check.h"
+#include "model.h"
+#include "parameters.h"
+
+namespace {
+
+// Share of the flight time in bin b of four, one electron flying from x
+// along angle for elapsed ms at speed 100 clear of the atoms
+qreal binShare(Model::Engine engine, Model::Boundary boundary, int b, int x, qreal angle, int elapsed)
+{
+	Parameters p;
+	p.num = 0;
+	p.nbins = 4;
+	p.bin = b + 1;
+	p.engine = engine;
+	p.boundary = boundary;
+	Model model;
+	p.apply(model);
+	// between the rows of atoms at y = 0 and 25
+	model.add(x, 12, angle);
+	model.step(elapsed);
+	return model.getProb().last();
+}
+
+}
+
+// A model following the last electrons of another moves them as it does
+bool testModelFollow()
+{
+	for (int g = 0; g < 3; g++) {
+		for (int e = 0; e < 2; e++) {
+			Parameters p;
+			p.num = 3000;
+			p.threads = 2;
+			p.geometry = Model::Geometry(g);
+			p.boundary = g == Model::TriangularGeometry ? Model::PeriodicBoundary : Model::ReflectingBoundary;
+			p.engine = e ? Model::EventDrivenEngine : Model::TimeStepEngine;
+			Model model;
+			p.apply(model);
+			model.step(50);
+			model.add(100, 13, 0.3);
+			model.step(37);
+
+			const int first = 2990;
+			Model ahead;
+			ahead.follow(model, first);
+			ahead.setPaintTraceOnly(true);
+			CHECK(ahead.getNumber() == model.getNumber() - first);
+			for (int k = 0; k < 20; k++) {
+				model.step(50);
+				ahead.step(50);
+			}
+			model.sync();
+			ahead.sync();
+			const Particles& a = model.getParticles();
+			const Particles& b = ahead.getParticles();
+			// the measurements sync the event-driven engine at other times
+			for (int i = 0; i < ahead.getNumber(); i++)
+				CHECK(qAbs(a.x[first + i] - b.x[i]) < 1e-9 && qAbs(a.y[first + i] - b.y[i]) < 1e-9);
+		}
+	}
+	return true;
+}
+
+// The flight time credited to the bins adds up to the whole of it
+bool testModelBinSum()
+{
+	for (int e = 0; e < 2; e++) {
+		for (int bd = 0; bd < 2; bd++) {
+			qreal sum = 0;
+			for (int b = 0; b < 5; b++) {
+				Parameters p;
+				p.num = 500;
+				p.nbins = 5;
+				p.bin = b + 1;
+				p.engine = e ? Model::EventDrivenEngine : Model::TimeStepEngine;
+				p.boundary = Model::Boundary(bd);
+				Model model;
+				p.apply(model);
+				for (int k = 0; k < 20; k++)
+					model.step(50);
+				CHECK(model.getProb().last() > 0);
+				sum += model.getProb().last();
+			}
+			CHECK(qAbs(sum - 1) < 1e-12);
+		}
+	}
+	return true;
+}
+
+// A segment crossing bins credits each with the length it covers there
+bool testModelBinSplit()
+{
+	for (int e = 0; e < 2; e++) {
+		Model::Engine engine = e ? Model::EventDrivenEngine : Model::TimeStepEngine;
+		// from 150 to 350 in bins of 100, either way
+		const qreal across[4] = { 0, 0.25, 0.5, 0.25 };
+		for (int b = 0; b < 4; b++) {
+			CHECK(qAbs(binShare(engine, Model::ReflectingBoundary, b, 150, 0, 2000) - across[b]) < 1e-12);
+			CHECK(qAbs(binShare(engine, Model::ReflectingBoundary, b, 350, M_PI, 2000) - across[b]) < 1e-12);
+		}
+		// from 350 through the edge of the periodic box at 400 to 50
+		const qreal wrapped[4] = { 0.5, 0, 0, 0.5 };
+		for (int b = 0; b < 4; b++)
+			CHECK(qAbs(binShare(engine, Model::PeriodicBoundary, b, 350, 0, 1000) - wrapped[b]) < 1e-12);
+	}
+	return true;
+}
+
+// The density history is trimmed along with the series, each point keeping
+// the density measured with it
+bool testModelDensities()
+{
+	for (int h = 0; h < 2; h++) {
+		Parameters p;
+		p.num = 200;
+		p.nbins = 4;
+		Model full;
+		p.apply(full);
+		p.history = Model::HistoryPolicy(h);
+		p.historySize = 8;
+		Model trimmed;
+		p.apply(trimmed);
+		for (int k = 0; k < 100; k++) {
+			full.step(50);
+			trimmed.step(50);
+		}
+
+		QVector<qreal> time = trimmed.getTime();
+		QVector<QVector<qreal> > densities = trimmed.getDensities();
+		QVector<qreal> fullTime = full.getTime();
+		QVector<QVector<qreal> > fullDensities = full.getDensities();
+		CHECK(fullDensities.size() == fullTime.size());
+		CHECK(fullTime.size() > 2 * p.historySize);
+		CHECK(densities.size() == time.size());
+		CHECK(densities.last() == trimmed.getDensity());
+		int j = 0;
+		for (int i = 0; i < time.size(); i++) {
+			while (j < fullTime.size() && fullTime[j] != time[i])
+				j++;
+			CHECK(j < fullTime.size());
+			CHECK(densities[i] == fullDensities[j]);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,143 @@
+#include <qmath.h>
+
+#include <stdlib.h>
+
+#include "check.h"
+#include "model.h"
+#include "parameters.h"
+#include "scatterers.h"
+
+namespace {
+
+qreal distance(const QPointF& a, const QPointF& b)
+{
+	return qSqrt((a.x() - b.x())*(a.x() - b.x()) + (a.y() - b.y())*(a.y() - b.y()));
+}
+
+}
+
+// A periodic grid answers as a full search over the images of its atoms
+bool testPeriodicGrid()
+{
+	const qreal W = 300, H = 200;
+	QVector<QPointF> atoms = ScattererGrid::scatter(150, 12, W, H, true, 3);
+	CHECK(atoms.size() == 150);
+
+	// the rays below reach at most two periods away
+	QVector<QPointF> images;
+	for (int i = -3; i <= 3; i++)
+		for (int j = -3; j <= 3; j++)
+			for (int a = 0; a < atoms.size(); a++)
+				images.append(QPointF(atoms[a].x() + i*W, atoms[a].y() + j*H));
+
+	// the distance holds across the edges
+	for (int a = 0; a < atoms.size(); a++)
+		for (int b = 0; b < images.size(); b++)
+			CHECK(b == a + 24*atoms.size() || distance(atoms[a], images[b]) >= 12);
+
+	// cells smaller than the atoms, and one or two for the whole area
+	qreal cells[3] = { 17, 150, 400 };
+	for (int s = 0; s < 3; s++) {
+		ScattererGrid grid(atoms, W, H, cells[s], true);
+		srand(5);
+		for (int k = 0; k < 5000; k++) {
+			QPointF p(rand() % 30000 / 100.0 - 10, rand() % 20000 / 100.0 + 5);
+			qreal best = std::numeric_limits<qreal>::infinity();
+			for (int b = 0; b < images.size(); b++)
+				best = qMin(best, distance(p, images[b]));
+			qreal xC, yC;
+			CHECK(qAbs(qSqrt(grid.nearest(p.x(), p.y(), xC, yC)) - best) < 1e-9);
+			qreal r = rand() % 300 / 10.0;
+			CHECK(grid.overlaps(p.x(), p.y(), r) == (best <= r));
+
+			qreal angle = rand() % 6283 / 1000.0;
+			QPointF d(qCos(angle), qSin(angle));
+			qreal R = 3 + rand() % 100 / 10.0;
+			qreal tMax = rand() % 300;
+			qreal t, tBrute = tMax;
+			QPointF centre;
+			bool hit = grid.firstHit(p, d, R, tMax, t, centre);
+			bool hitBrute = false;
+			for (int b = 0; b < images.size(); b++) {
+				qreal rx = p.x() - images[b].x();
+				qreal ry = p.y() - images[b].y();
+				qreal bb = rx*d.x() + ry*d.y();
+				qreal q = rx*rx + ry*ry - R*R;
+				if (bb >= 0 || q <= 0 || bb*bb - q < 0)
+					continue;
+				qreal th = -bb - qSqrt(bb*bb - q);
+				if (th < tBrute) {
+					tBrute = th;
+					hitBrute = true;
+				}
+			}
+			CHECK(hit == hitBrute);
+			CHECK(!hit || qAbs(t - tBrute) < 1e-9);
+		}
+	}
+	return true;
+}
+
+// Both engines follow the same paths through the periodic box
+bool testPeriodicEngines()
+{
+	for (int g = 0; g < 3; g++) {
+		Parameters p;
+		p.num = 500;
+		p.threads = 2;
+		p.geometry = Model::Geometry(g);
+		p.boundary = Model::PeriodicBoundary;
+		p.width = 410;
+		p.height = 390;
+		p.atomR = g == Model::SquareGeometry ? 5 : 8;
+
+		Model timed, events;
+		p.engine = Model::TimeStepEngine;
+		p.apply(timed);
+		p.engine = Model::EventDrivenEngine;
+		p.apply(events);
+		for (int k = 0; k < 8; k++) {
+			timed.step(50);
+			events.step(50);
+		}
+		events.sync();
+
+		QVector<QPointF> a = timed.getDisplacements();
+		QVector<QPointF> b = events.getDisplacements();
+		CHECK(a.size() == 500 && b.size() == 500);
+		const Particles& particles = timed.getParticles();
+		for (int i = 0; i < a.size(); i++) {
+			CHECK(distance(a[i], b[i]) < 1e-8);
+			CHECK(particles.x[i] >= 0 && particles.x[i] <= timed.getBoxWidth());
+			CHECK(particles.y[i] >= 0 && particles.y[i] <= timed.getBoxHeight());
+		}
+		// crossings are not wall hits
+		CHECK(timed.getImpulses().last() == 0);
+	}
+	return true;
+}
+
+// An electron in a row free of atoms is displaced by its whole path
+bool testPeriodicCorridor()
+{
+	for (int e = 0; e < 2; e++) {
+		Parameters p;
+		p.num = 0;
+		p.atomR = 5;
+		p.electronR = 2;
+		p.boundary = Model::PeriodicBoundary;
+		p.engine = e ? Model::EventDrivenEngine : Model::TimeStepEngine;
+		Model model;
+		p.apply(model);
+		model.add(100, 12, 0);
+		model.add(399, 12, M_PI);
+		for (int k = 0; k < 200; k++)
+			model.step(50);
+		model.sync();
+
+		QVector<QPointF> d = model.getDisplacements();
+		CHECK(qAbs(d[0].x() - 1000) < 1e-9 && qAbs(d[0].y()) < 1e-9);
+		CHECK(qAbs(d[1].x() + 1000) < 1e-9 && qAbs(d[1].y()) < 1e-9);
+	}
+	return true;
+}
@@ -0,0 +1,90 @@
+#include <stdlib.h>
+
+#include "check.h"
+#include "qcustomplotdata.h"
+
+namespace {
+
+QCustomPlotData point(double key, double value, bool withErrors)
+{
+	QCustomPlotData data;
+	data.key = key;
+	data.value = value;
+	if (withErrors) {
+		data.keyErrorPlus = value + 0.1;
+		data.keyErrorMinus = value + 0.2;
+		data.valueErrorPlus = value + 0.3;
+		data.valueErrorMinus = value + 0.4;
+	}
+	return data;
+}
+
+bool same(const QCustomPlotDataArray& array, const QCustomPlotDataMap& map)
+{
+	if (array.size() != map.size())
+		return false;
+	int i = 0;
+	for (QCustomPlotDataMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it, ++i) {
+		QCustomPlotData a = array.at(i);
+		const QCustomPlotData& b = it.value();
+		if (a.key != b.key || a.value != b.value ||
+			a.keyErrorPlus != b.keyErrorPlus || a.keyErrorMinus != b.keyErrorMinus ||
+			a.valueErrorPlus != b.valueErrorPlus || a.valueErrorMinus != b.valueErrorMinus)
+			return false;
+	}
+	return true;
+}
+
+}
+
+/*
+ * The data array orders its points as the QMap it replaces: each way of
+ * inserting, in any key order and with repeated keys, against
+ * QMap::insertMulti, or QMap::unite for a map.
+ */
+bool testDataArrayInsert()
+{
+	srand(7);
+	for (int trial = 0; trial < 2000; trial++) {
+		QCustomPlotDataArray array;
+		QCustomPlotDataMap reference;
+		double id = 1;
+		for (int round = 0; round < 5; round++) {
+			int count = rand() % 20;
+			bool withErrors = trial % 3 == 0 && rand() % 2;
+			QVector<QCustomPlotData> points(count);
+			for (int j = 0; j < count; j++)
+				points[j] = point(rand() % 8, id++, withErrors);
+
+			switch (rand() % 4) {
+			case 0:
+				for (int j = 0; j < count; j++) {
+					array.insert(points[j].key, points[j].value);
+					reference.insertMulti(points[j].key, point(points[j].key, points[j].value, false));
+				}
+				break;
+			case 1:
+				for (int j = 0; j < count; j++) {
+					array.insert(points[j]);
+					reference.insertMulti(points[j].key, points[j]);
+				}
+				break;
+			case 2:
+				array.insert(points);
+				for (int j = 0; j < count; j++)
+					reference.insertMulti(points[j].key, points[j]);
+				break;
+			case 3: {
+				QCustomPlotDataMap map;
+				for (int j = 0; j < count; j++)
+					map.insertMulti(points[j].key, points[j]);
+				array.insert(map);
+				reference.unite(map);
+				break;
+			}
+			}
+			CHECK(same(array, reference));
+		}
+	}
+	return true;
+}
@@ -0,0 +1,55 @@
+#include "check.h"
+#include "random.h"
+
+/*
+ * Known-answer vectors of Philox4x32-10 published with Random123
+ * (kat_vectors, Salmon et al. 2011): counter, key, output.
+ */
+bool testPhiloxKnownAnswers()
+{
+	static const quint32 vectors[3][10] = {
+		{ 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		  0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+		{ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+		  0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+		{ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+		  0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+	};
+
+	for (int v = 0; v < 3; v++) {
+		quint32 out[4];
+		Random::philox(vectors[v], vectors[v] + 4, out);
+		for (int i = 0; i < 4; i++)
+			CHECK(out[i] == vectors[v][6 + i]);
+	}
+
+	// the generator draws block 0 of stream 0 under the seed as its key
+	Random random(0, 0);
+	for (int i = 0; i < 4; i++)
+		CHECK(random.next() == vectors[0][6 + i]);
+	return true;
+}
+
+// Streams of one seed differ, and a stream does not depend on the others
+bool testRandomStreams()
+{
+	Random a(1, 0);
+	Random b(1, 1);
+	Random c(2, 0);
+	int same = 0;
+	for (int i = 0; i < 1000; i++) {
+		quint32 x = a.next();
+		same += x == b.next();
+		same += x == c.next();
+	}
+	CHECK(same < 3);
+
+	Random first(7, 5);
+	Random again(7, 5);
+	for (int i = 0; i < 1000; i++) {
+		qreal u = first.uniform();
+		CHECK(u >= 0 && u < 1);
+		CHECK(u == again.uniform());
+	}
+	return true;
+}
@@ -0,0 +1,132 @@
+#include <qmath.h>
+
+#include <stdlib.h>
+
+#include "check.h"
+#include "scatterers.h"
+
+namespace {
+
+struct Probe {
+	qreal x, y;
+	qreal r;		// overlap radius
+	QPointF d;		// ray direction
+	qreal R;		// ray radius
+	qreal tMax;
+};
+
+Probe probe(qreal width, qreal height)
+{
+	Probe p;
+	p.x = rand() % 10000 * width / 10000;
+	p.y = rand() % 10000 * height / 10000;
+	p.r = rand() % 200 / 10.0;
+	qreal angle = rand() % 6283 / 1000.0;
+	p.d = QPointF(qCos(angle), qSin(angle));
+	p.R = 3 + rand() % 150 / 10.0;
+	p.tMax = rand() % 300;
+	return p;
+}
+
+qreal bruteNearest(const QVector<QPointF>& atoms, qreal x, qreal y)
+{
+	qreal best = std::numeric_limits<qreal>::infinity();
+	for (int a = 0; a < atoms.size(); a++)
+		best = qMin(best, (x - atoms[a].x())*(x - atoms[a].x()) + (y - atoms[a].y())*(y - atoms[a].y()));
+	return best;
+}
+
+// First disk hit along the ray, as ScattererGrid::firstHit defines it
+bool bruteHit(const QVector<QPointF>& atoms, const Probe& p, qreal& t)
+{
+	bool found = false;
+	t = p.tMax;
+	for (int a = 0; a < atoms.size(); a++) {
+		qreal rx = p.x - atoms[a].x();
+		qreal ry = p.y - atoms[a].y();
+		qreal b = rx*p.d.x() + ry*p.d.y();
+		qreal q = rx*rx + ry*ry - p.R*p.R;
+		if (b >= 0 || q <= 0 || b*b - q < 0)
+			continue;
+		qreal th = -b - qSqrt(b*b - q);
+		if (th < t) {
+			t = th;
+			found = true;
+		}
+	}
+	return found;
+}
+
+}
+
+// Random atoms keep their distance and the grid answers as a full search
+bool testScattererGrid()
+{
+	QVector<QPointF> atoms = ScattererGrid::scatter(256, 10, 400, 400, false, 1);
+	CHECK(atoms.size() == 256);
+	qreal closest = std::numeric_limits<qreal>::infinity();
+	for (int a = 0; a < atoms.size(); a++)
+		for (int b = a + 1; b < atoms.size(); b++)
+			closest = qMin(closest, qSqrt((atoms[a].x() - atoms[b].x())*(atoms[a].x() - atoms[b].x()) +
+										  (atoms[a].y() - atoms[b].y())*(atoms[a].y() - atoms[b].y())));
+	CHECK(closest >= 10);
+
+	// clustered atoms and atoms outside the area go to the border cells
+	srand(3);
+	for (int k = 0; k < 60; k++)
+		atoms.append(QPointF(rand() % 4400 / 10.0 - 20, rand() % 4400 / 10.0 - 20));
+	for (int k = 0; k < 30; k++)
+		atoms.append(QPointF(200 + rand() % 100 / 10.0, 200 + rand() % 100 / 10.0));
+	ScattererGrid grid(atoms, 400, 400, 17, false);
+	CHECK(grid.size() == atoms.size());
+
+	for (int k = 0; k < 5000; k++) {
+		Probe p = probe(400, 400);
+		qreal xC, yC;
+		qreal best = bruteNearest(atoms, p.x, p.y);
+		CHECK(qAbs(grid.nearest(p.x, p.y, xC, yC) - best) < 1e-9);
+		CHECK(grid.overlaps(p.x, p.y, p.r) == (best <= p.r*p.r));
+
+		qreal t, tBrute;
+		QPointF centre;
+		bool hit = grid.firstHit(QPointF(p.x, p.y), p.d, p.R, p.tMax, t, centre);
+		CHECK(hit == bruteHit(atoms, p, tBrute));
+		CHECK(!hit || qAbs(t - tBrute) < 1e-9);
+	}
+	return true;
+}
+
+/*
+ * The queries only visit the cells around a point or along a ray, so at
+ * a fixed density the atoms they test do not grow with the number of
+ * atoms: a million atoms are searched as a thousand are.
+ */
+bool testScattererGridScales()
+{
+	const int queries = 20000;
+	qreal perQuery[2];
+	int sizes[2] = { 1000, 1000000 };
+	for (int s = 0; s < 2; s++) {
+		qreal side = qSqrt(sizes[s] * 625.0);
+		QVector<QPointF> atoms = ScattererGrid::scatter(sizes[s], 10, side, side, false, 1);
+		CHECK(atoms.size() == sizes[s]);
+		ScattererGrid grid(atoms, side, side, 25, false);
+
+		srand(5);
+		qint64 tested = 0;
+		for (int k = 0; k < queries; k++) {
+			Probe p = probe(side, side);
+			qreal xC, yC, t;
+			QPointF centre;
+			int count = 0;
+			grid.nearest(p.x, p.y, xC, yC, &count);
+			grid.firstHit(QPointF(p.x, p.y), p.d, 7, 50, t, centre, &count);
+			tested += count;
+		}
+		perQuery[s] = qreal(tested) / queries;
+	}
+	// about 29 and 31, the small grid has more of its queries by the edges
+	CHECK(perQuery[1] < 1.25*perQuery[0]);
+	CHECK(perQuery[1] < 100);
+	return true;
+}
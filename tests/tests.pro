@@ -0,0 +1,25 @@
+# Checks of the physics core and of the plot data: qmake && make && ./lorentz-tests
+# (or make check), exits with the number of failed tests
+QT -= gui
+
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = lorentz-tests
+
+include(../src/core/core.pri)
+
+# the data storage of the plot, free of the widget
+INCLUDEPATH += ../src
+HEADERS += check.h \
+           ../src/qcustomplotdata.h
+
+SOURCES += main.cpp \
+           random_test.cpp \
+           scatterers_test.cpp \
+           periodic_test.cpp \
+           model_test.cpp \
+           ensemble_test.cpp \
+           qcustomplotdata_test.cpp \
+           ../src/qcustomplotdata.cpp